@@ -1,20 +1,68 @@
-// // LoopManager.h
+// LoopManager.h
+// Cooperative, deadline-based task scheduler with a fixed task table.
+// Each pass runs every ready task once, highest priority first and, within
+// a priority, earliest deadline first. Time-critical tasks therefore always
+// run before UI redraw. Every run is timed against the task's budget.
 
-// #ifndef LOOPMANAGER_H
-// #define LOOPMANAGER_H
+#ifndef LOOPMANAGER_H
+#define LOOPMANAGER_H
 
-// typedef void (*TaskFunc)();
+#include <stdint.h>
 
-// #define MAX_TASKS 4
-// static TaskFunc loopTasks[MAX_TASKS];
-// static int loopTaskCount = 0;
+typedef void (*TaskFunc)();
 
-// inline void registerLoopTask(TaskFunc f) {
-//   if (loopTaskCount < MAX_TASKS) loopTasks[loopTaskCount++] = f;
-// }
+#ifndef MAX_TASKS
+#define MAX_TASKS 8
+#endif
+static_assert(MAX_TASKS <= 8, "ran-this-pass mask is 8 bits");
 
-// inline void runLoopTasks() {
-//   for (int i = 0; i < loopTaskCount; i++) loopTasks[i]();
-// }
+// Lower value = more urgent
+enum TaskPriority : uint8_t {
+  PRIO_OUTPUT     = 0,   // clock-driven outputs, event delivery
+  PRIO_INPUT      = 1,   // buttons, matrix
+  PRIO_CONTROL    = 2,   // pots, backlight
+  PRIO_UI         = 3,   // display update/draw
+  PRIO_BACKGROUND = 4    // storage, diagnostics
+};
 
-// #endif
+// Period value for tasks that only run when triggered
+#define TASK_ON_DEMAND 0xFFFF
+
+struct LoopTask {
+  const char* nameP;     // PROGMEM name for the DEBUG page
+  TaskFunc fn;
+  uint16_t periodMs;     // 0 = every pass, TASK_ON_DEMAND = trigger only
+  uint16_t budgetUs;     // expected worst case per run
+  uint8_t  prio;
+  volatile uint8_t triggered;   // set by triggerLoopTask() (ISR-safe)
+  uint8_t  wakePending;  // on-demand task: one-shot release at nextDue
+  unsigned long nextDue; // millis() deadline of the next periodic/one-shot release
+  // stats
+  uint16_t runs;
+  uint16_t overruns;     // runs that exceeded budgetUs
+  uint16_t misses;       // periodic releases skipped because we were late
+  uint16_t lastUs;
+  uint16_t maxUs;
+};
+
+// Add a task; returns its id or -1 if the table is full.
+int8_t registerLoopTask(const char* nameP, TaskFunc fn, uint16_t periodMs,
+                        uint8_t prio, uint16_t budgetUs);
+
+// Mark a task ready for the next scheduling decision (safe from ISRs).
+void triggerLoopTask(int8_t id);
+
+// Release a TASK_ON_DEMAND task once, ms from now (main loop only). With
+// several requests pending the earliest wins; callers re-request if woken early.
+void wakeLoopTaskIn(int8_t id, uint16_t ms);
+
+// One cooperative pass; call from loop().
+void runLoopTasks();
+
+// Read access for the DEBUG page / serial
+uint8_t loopTaskCount();
+const LoopTask* loopTask(uint8_t id);
+void resetLoopTaskStats();
+void dumpLoopTasks();
+
+#endif // LOOPMANAGER_H
@@ -0,0 +1,49 @@
+// adc_scan.h
+// Background pot scanner. ADC_vect walks every pot round robin: the 16
+// CD4067 step pots (S0-S3 on PA0-PA3, one port write per channel), the
+// ten instrument pots and the brightness pot. Each channel is read
+// ADC_OVERSAMPLE times after one settling conversion, averaged, and only
+// accepted once it moves more than ADC_HYST counts. Accepted moves update
+// the value table and go out as coalesced EVT_POT_MOVE (a = channel,
+// b = value / 4) straight from the ISR, so a sweep costs the loop nothing.
+#ifndef ADC_SCAN_H
+#define ADC_SCAN_H
+
+#include <stdint.h>
+#include "config.h"
+
+// Logical channels (= EVT_POT_MOVE .a)
+enum AdcChannel : uint8_t {
+  ADC_CH_STEP0  = 0,    // 4067 channels 0..15
+  ADC_CH_INST0  = 16,   // PIN_INST_POT_1..10
+  ADC_CH_BRIGHT = 26,   // PIN_BRIGHT_POT (backlight, no event)
+  ADC_CH_COUNT  = 27
+};
+
+// Conversions averaged per channel visit (power of two, <= 16)
+#ifndef ADC_OVERSAMPLE
+#define ADC_OVERSAMPLE 4
+#endif
+
+// Counts (0..1023 scale) a channel must move before it's accepted
+#ifndef ADC_HYST
+#define ADC_HYST 3
+#endif
+
+// Bound on the wait in adc_init() for the value table to fill
+#ifndef ADC_FIRST_SWEEP_MS
+#define ADC_FIRST_SWEEP_MS 50
+#endif
+
+// Start the scanner (ADC clock F_CPU/128, AVcc reference) and wait for
+// the first full sweep. Call after stepPots_init(); after this,
+// analogRead() must not be used.
+void adc_init();
+
+// Last accepted value, 0..1023
+uint16_t adc_value(uint8_t ch);
+
+// Completed sweeps over all channels (wraps); 0 until the table is filled
+uint16_t adc_sweeps();
+
+#endif // ADC_SCAN_H
@@ -1,2 +1,47 @@
 #pragma once
-// Reserved for any Timer/ISR quirks or conditional includes
\ No newline at end of file
+// Reserved for any Timer/ISR quirks or conditional includes
+
+// --- Hardware timer allocation (ATmega2560) ---
+//  Timer0 : Arduino core millis()/micros(); COMPB = function-key sampling
+//           (hal_buttons_simple) → no analogWrite on 4
+//  Timer1 : backlight PWM on pins 11/12 (prescaler set in hal_backlight)
+//  Timer2 : tone()
+//  Timer3 : sequencer clock, CTC on OCR3A (seq_clock) → no analogWrite on 2/3/5
+//  Timer5 : free-running timebase, 0.5 us/tick (timebase) → no analogWrite on 44/45/46
+//  INT2   : MCP23017 interrupt on pin 19 / PD2, low level (button_matrix)
+//  INT4   : external clock input on pin 2 / PE4 (ext_clock)
+//  ADC    : free-running pot scan from ADC_vect (adc_scan) → no analogRead()
+
+// --- Display port bits (direct-port ST7920 transports, display_st7920) ---
+//  Must match the Arduino pins in config_pins.h; checked once at init.
+//  SW SPI : LCD_CLK 13 = PB7, LCD_MOSI 11 = PB5, LCD_CS 10 = PB4
+//  HW SPI : SCK 52 = PB1, MOSI 51 = PB2, CS 53 = PB0 (SS, also SD's default CS)
+#define LCD_PORT        PORTB
+#define LCD_DDR         DDRB
+#define LCD_CLK_BIT     PB7
+#define LCD_MOSI_BIT    PB5
+#define LCD_CS_BIT      PB4
+#define LCD_HW_SCK_BIT  PB1
+#define LCD_HW_MOSI_BIT PB2
+#define LCD_HW_CS_BIT   PB0
+#define LCD_HW_CS       53
+
+// --- Function-key port bits (hal_buttons_simple) ---
+//  All function keys sit on PORTL, which has no pin-change interrupts, so
+//  the port is sampled as a byte from TIMER0_COMPB. Checked once at init.
+//  LIVE 42 = PL7, DOWN 43 = PL6, UP 44 = PL5, SELECT 45 = PL4, BACK 46 = PL3
+#define FNKEY_PIN        PINL
+#define FNKEY_PORT       PORTL
+#define FNKEY_DDR        DDRL
+#define BTN_LIVE_BIT     PL7
+#define BTN_DOWN_BIT     PL6
+#define BTN_UP_BIT       PL5
+#define BTN_SELECT_BIT   PL4
+#define BTN_BACK_BIT     PL3
+
+// --- Step-pot mux select bits (CD4067, step_pots_4067 / adc_scan) ---
+//  S0..S3 on consecutive bits of one port so a channel is one write.
+//  S0 22 = PA0, S1 23 = PA1, S2 24 = PA2, S3 25 = PA3 (EN 26 = PA4)
+#define MUX_SEL_PORT     PORTA
+#define MUX_SEL_SHIFT    PA0
+#define MUX_SEL_MASK     (0x0F << MUX_SEL_SHIFT)
@@ -1,5 +1,53 @@
 // button_matrix.h
+// Pad matrices on MCP23017 expanders ("banks"): GPA = rows (driven, active
+// low), GPB = columns (inputs with pull-ups, one diode per key), up to 8x8
+// per bank. Between scans all rows are parked low, so any press or release
+// changes a column and the expander's interrupt-on-change pulls the shared
+// PIN_MCP_INT low. Only then are the banks that flagged it (INTFB) scanned
+// and diffed; each changed key becomes EVT_KEY_DOWN/UP on the bank's
+// source with a = row, b = col. An idle grid costs no bus traffic.
+// All bus access is queued on the TWI engine (twi.h); nothing here blocks.
 #pragma once
 #include <stdint.h>
+
+// Bank A: the 6x6 pad grid
+#define BTNMX_ROWS 6
+#define BTNMX_COLS 6
+
+// Number of expanders; bank B (SRC_MATRIX_B) is the second entry of the
+// bank table in button_matrix.cpp
+#ifndef BTNMX_BANKS
+#define BTNMX_BANKS 1
+#endif
+#ifndef BTNMX_B_ROWS
+#define BTNMX_B_ROWS 8
+#endif
+#ifndef BTNMX_B_COLS
+#define BTNMX_B_COLS 8
+#endif
+
+// After a scan that found changes the interrupt stays masked this long,
+// so contact bounce folds into one follow-up scan
+#ifndef BTNMX_SETTLE_MS
+#define BTNMX_SETTLE_MS 5
+#endif
+
+// Retry interval while an expander doesn't answer
+#ifndef BTNMX_RETRY_MS
+#define BTNMX_RETRY_MS 500
+#endif
+
 void btnmx_init();
-uint32_t btnmx_read(); // returns a 36-
\ No newline at end of file
+
+// Task woken on an expander interrupt (register it TASK_ON_DEMAND)
+void btnmx_setTask(int8_t taskId);
+
+// Queue scans if the interrupt fired, publish changed keys once they're
+// back, re-arm when settled. Call after twi_poll() in the same task.
+void btnmx_poll();
+
+// Debounced column bits of one row (bit c = key (row, c) down)
+uint8_t btnmx_row(uint8_t bank, uint8_t row);
+
+// A bank's whole 64-bit state word, row 0 in the low byte
+uint64_t btnmx_state(uint8_t bank);
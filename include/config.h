@@ -25,6 +25,8 @@
 #define KEY_DOWN   IN_DOWN
 #define KEY_UP     IN_UP
 
+#ifndef DEBUG_SERIAL      // release env passes -DDEBUG_SERIAL=0
 #define DEBUG_SERIAL 1   // set to 0 to strip all debug I/O
+#endif
 #define DEBUG_BAUD   115200
 
@@ -14,8 +14,11 @@ static_assert(UINT8_MAX == 255,     "uint8_t must be 0..255");
 #ifndef MAX_SUBCONTEXTS
   #define MAX_SUBCONTEXTS 16
 #endif
+/* Main-loop event ring (power of two). It carries every key edge, and one
+   matrix scan can push a change for each key it covers: 32 takes any
+   realistic chord on the 6x6 bank in one pass (8 bytes a slot). */
 #ifndef EVENT_QUEUE_LEN
-  #define EVENT_QUEUE_LEN 16
+  #define EVENT_QUEUE_LEN 32
 #endif
 #ifndef CTX_HISTORY_LEN
   #define CTX_HISTORY_LEN 8
@@ -1,6 +1,7 @@
  #pragma once
 #define USE_WS2812 1
-#define USE_BUTTON_MATRIX 1 // 0 = direct GPIO or multiple MCPs
+#define USE_BUTTON_MATRIX 1 // MCP23017 pad banks (count: BTNMX_BANKS in button_matrix.h)
 #define USE_4067_STEPPOTS 1
+#define USE_EXT_CLOCK 1 // follow clock pulses on PIN_EXT_CLOCK
 #define NUM_STEPS 16
 #define NUM_INSTR 10
\ No newline at end of file
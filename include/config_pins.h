@@ -72,6 +72,8 @@
 
 // --- MCP23017 for Button Matrix ---
 #define I2C_ADDR_MCP 0x20
+#define I2C_ADDR_MCP_B 0x21   // second pad bank (BTNMX_BANKS 2)
+#define PIN_MCP_INT 19   // INTA/INTB mirrored, open drain → INT2
 
 // --- Temp buttons for setup/test
  #define BTN_LEFT    40
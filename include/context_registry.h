@@ -21,4 +21,7 @@ uint8_t getRegisteredContextCount();
 // Retrieves a context by index (for debug/UI iteration)
 ContextObject* getContextByIndex(uint8_t index);
 
+// Reverse lookup: registry index of ctx, or -1 if not registered
+int8_t getContextIndex(const ContextObject* ctx);
+
 #endif // CONTEXT_REGISTRY_H
@@ -0,0 +1,11 @@
+// debug_console.h
+// Single-letter serial commands for field diagnostics (debug builds only).
+//   ?  help
+//   p  dump loop profiler        P  reset profiler
+#ifndef DEBUG_CONSOLE_H
+#define DEBUG_CONSOLE_H
+
+// Poll Serial for a command byte and run it. No-op when DEBUG_SERIAL is 0.
+void console_poll();
+
+#endif // DEBUG_CONSOLE_H
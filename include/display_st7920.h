@@ -0,0 +1,136 @@
+// display_st7920.h
+// ST7920 display backend. Wraps U8g2's ST7920 driver so that only pixel
+// rows that changed since the last frame are sent (trimmed to the changed
+// 16-pixel words). Works with both the page buffer and the full frame
+// buffer; the full buffer also runs each draw() once instead of 8 times.
+#ifndef DISPLAY_ST7920_H
+#define DISPLAY_ST7920_H
+
+#include <stdint.h>
+#include <U8g2lib.h>
+#include "config.h"
+
+class ContextObject;
+
+// Byte transport to the controller
+#define DISP_TRANSPORT_U8G2  0   // U8g2's stock SW SPI on LCD_CLK/LCD_MOSI/LCD_CS
+#define DISP_TRANSPORT_PORT  1   // same pins, direct PORTB writes, unrolled bytes
+#define DISP_TRANSPORT_HWSPI 2   // SPI peripheral: SCK 52, MOSI 51, CS LCD_HW_CS
+#ifndef DISP_TRANSPORT
+#define DISP_TRANSPORT DISP_TRANSPORT_PORT
+#endif
+
+// SW SPI clock-high time the ST7920 needs (tSHW, also tSLW)
+#ifndef LCD_TSHW_NS
+#define LCD_TSHW_NS 200
+#endif
+// Extra NOPs per SW SPI half clock. A half clock is the NOPs plus the
+// 2-cycle sbi/cbi that ends it, so: cycles for tSHW rounded up, minus 2
+// (2 at 16 MHz: 4 cycles = 250 ns).
+#define LCD_TSHW_CYCLES (((uint32_t)LCD_TSHW_NS * (F_CPU / 1000000UL) + 999) / 1000)
+#ifndef LCD_SPI_NOPS
+#define LCD_SPI_NOPS ((uint8_t)(LCD_TSHW_CYCLES > 2 ? LCD_TSHW_CYCLES - 2 : 0))
+#endif
+
+// 1 = full 1 KB frame buffer (U8G2_ST7920_128X64_F_*), 0 = one-page buffer
+#ifndef DISP_FULL_BUFFER
+#define DISP_FULL_BUFFER 1
+#endif
+
+// 1 = the frame buffer is sent by disp_pump() in half-row chunks spread
+// over loop passes; no new frame is drawn until the last chunk is out, so
+// frames never tear. Needs the full buffer (page mode sends synchronously).
+#ifndef DISP_ASYNC_FLUSH
+#define DISP_ASYNC_FLUSH DISP_FULL_BUFFER
+#endif
+#if DISP_ASYNC_FLUSH && !DISP_FULL_BUFFER
+#error "DISP_ASYNC_FLUSH requires DISP_FULL_BUFFER"
+#endif
+
+// Time disp_pump() may spend per loop pass (one chunk may overshoot it)
+#ifndef DISP_PUMP_BUDGET_US
+#define DISP_PUMP_BUDGET_US 1000
+#endif
+
+// 1 = keep a 1 KB shadow of the display RAM and send only changed rows.
+// With the 1 KB frame buffer, U8g2, SD and our own tables the 2560 is at
+// an estimated ~7.0 KB static in release and ~7.7 KB in debug, leaving the
+// debug build about 0.5 KB of stack. The "ram:" line at boot and console
+// 'm' give the real figures (ram_stats.h); 0 hands the kilobyte back.
+#ifndef DISP_ROW_DIFF
+#define DISP_ROW_DIFF 1
+#endif
+
+// Per-context bytes/us counters and the serial benchmark (debug builds)
+#ifndef DISP_BENCH
+#define DISP_BENCH DEBUG_SERIAL
+#endif
+// Contexts with a counter row, in the order their first frame goes out
+#ifndef DISP_STAT_SLOTS
+#define DISP_STAT_SLOTS 6
+#endif
+
+#define DISP_WIDTH     128
+#define DISP_HEIGHT    64
+#define DISP_ROW_BYTES (DISP_WIDTH / 8)
+
+#if DISP_TRANSPORT != DISP_TRANSPORT_U8G2
+// ST7920 128x64 (full or page buffer per DISP_FULL_BUFFER) on our own
+// byte callback for DISP_TRANSPORT; pins come from board_profile.
+class U8G2_ST7920_128X64_FAST : public U8G2 {
+public:
+  explicit U8G2_ST7920_128X64_FAST(const u8g2_cb_t* rotation);
+};
+#endif
+
+// Install the diff hook. Call once, right after U8G2.begin().
+void disp_attach(U8G2* g);
+
+// Forget the shadow; the next frame is sent in full
+void disp_invalidate();
+
+// Bytes (commands + data, before ST7920 serial framing) sent since boot
+uint32_t disp_bytesSent();
+
+// Frames handed to the display since boot. With the full buffer, a
+// context that repaints in place compares it with the count right after
+// its own frame: unchanged means the buffer still holds that frame.
+uint32_t disp_frameCount();
+
+#if DISP_ASYNC_FLUSH
+// True while a drawn frame is still being sent; don't draw until it clears
+bool disp_busy();
+
+// Send chunks until budgetUs is used up; returns disp_busy()
+bool disp_pump(uint16_t budgetUs);
+
+// Send the rest of the frame in flight right away
+void disp_flush();
+#else
+inline bool disp_busy() { return false; }
+inline bool disp_pump(uint16_t) { return false; }
+inline void disp_flush() {}
+#endif
+
+#if DISP_BENCH
+// Bracket one ctx->draw(); accumulates bytes and microseconds per context
+// (with DISP_ASYNC_FLUSH the frame is booked once its last chunk is sent)
+void disp_frameBegin();
+void disp_frameEnd(const ContextObject* ctx);
+
+// Serial table of the accumulated per-context frame costs
+void disp_dumpStats();
+void disp_resetStats();
+
+// Draw every registered context twice: once with the shadow dropped (full
+// transfer) and once unchanged (diff only), and print bytes/us for both.
+void disp_benchmark();
+#else
+inline void disp_frameBegin() {}
+inline void disp_frameEnd(const ContextObject*) {}
+inline void disp_dumpStats() {}
+inline void disp_resetStats() {}
+inline void disp_benchmark() {}
+#endif
+
+#endif // DISPLAY_ST7920_H
@@ -2,6 +2,7 @@
 #ifndef EVENT_BUS_H
 #define EVENT_BUS_H
 #include <stdint.h>
+#include "config.h"
 
 
 // Event types your HAL can emit
@@ -11,7 +12,10 @@ EVT_KEY_DOWN,
 EVT_KEY_UP,
 EVT_POT_MOVE,
 EVT_TICK_1MS,
-EVT_TICK_24PPQN
+EVT_TICK_24PPQN,
+EVT_CLOCK_SYNC,   // SRC_CLOCK: a=1 following external clock, a=0 back on internal
+EVT_BUS_ERROR,    // SRC_I2C: a=TwiStatus, b=device address
+EVT_TYPE_COUNT
 };
 
 
@@ -23,7 +27,9 @@ SRC_FN_KEYS = 1, // function button bank (includes BTN_LIVE, SELECT, UP/DOWN)
 SRC_MATRIX_A = 2,
 SRC_MATRIX_B = 3,
 SRC_POTS = 4,
-SRC_CLOCK = 5
+SRC_CLOCK = 5,
+SRC_I2C = 6,
+SRC_COUNT
 };
 
 
@@ -39,10 +45,95 @@ static_assert(sizeof(Event)==4, "Event padded!");  // catch padding early
 //}
 
 
-// Push/pop (ring buffer). Use eb_pushFromISR in ISRs.
-bool eb_push(const Event& e);
-bool eb_pushFromISR(const Event& e);
+// Priority lanes. eb_pop() always empties a higher lane before looking at
+// a lower one, so knob traffic can never delay or push out clock events.
+enum EventLane : uint8_t {
+  LANE_CLOCK = 0,   // ticks, sync, transport (ring)
+  LANE_KEYS,        // key edges (ring)
+  LANE_CONTROL,     // continuous controls (coalesced, see below)
+  LANE_COUNT
+};
+
+// Which lane an event type travels in
+EventLane eb_laneOf(uint8_t type);
+
+// Continuous controls coalesce in place: one slot per control index (e.a),
+// a newer value overwrites one that hasn't been delivered yet. Each index
+// must have a single producer.
+#ifndef EB_CONTROL_SLOTS
+#define EB_CONTROL_SLOTS 32
+#endif
+
+// Ring slots always carry a 32-bit push stamp (the merge needs it). Control
+// slots get a compact 16-bit one (8 us units, ~0.5 s span) only when this
+// is set; otherwise eb_popStamped() reports them as pushed "now".
+#ifndef EB_CTRL_STAMPS
+#define EB_CTRL_STAMPS DEBUG_SERIAL
+#endif
+
+// Producer contexts. Each owns a single-producer/single-consumer ring with
+// 8-bit head/tail indices, so no push or pop ever disables interrupts.
+enum EventProducer : uint8_t {
+  PROD_MAIN = 0,     // main loop: buttons, pots, UI
+  PROD_CLOCK_ISR,    // TIMER3_COMPA (seq_clock ticks, sync loss)
+  PROD_EXTCLK_ISR,   // INT4 (ext_clock edges → seq_clock)
+  PROD_ADC_ISR,      // ADC_vect (adc_scan pot moves; control lane only, no ring)
+  PROD_COUNT
+};
+
+// Ring length per producer (power of two)
+#ifndef EB_RING_LEN_ISR
+#define EB_RING_LEN_ISR 8
+#endif
+
+// Push from the given producer context. Ring events are stamped with the
+// timebase; eb_pop() merges the rings by lane, then oldest stamp first.
+// Fails when that producer's ring is full (or e.a is out of control range).
+bool eb_pushFrom(uint8_t producer, const Event& e);
+inline bool eb_push(const Event& e) { return eb_pushFrom(PROD_MAIN, e); }
 bool eb_pop(Event& e);
+// Same, plus the timebase tick at which the event was pushed
+bool eb_popStamped(Event& e, uint32_t& pushedAt);
+
+// ---- Telemetry ----
+// Per-ring fill/high-water/drops and per-source/per-type totals, rates and
+// drops. Cheap enough to keep in release builds, where drops matter most.
+#ifndef EB_STATS
+#define EB_STATS 1
+#endif
+
+#if EB_STATS
+struct EbStat {
+  uint32_t total;    // events delivered by eb_pop()
+  uint16_t perSec;   // delivered during the last full second
+  uint16_t drops;    // pushes refused (ring full / bad control index)
+};
+
+// Roll the one-second rate window; call often (scheduler debug task)
+void eb_statsPoll();
+void eb_statsReset();
+
+void eb_statsBySource(uint8_t src, EbStat& out);
+void eb_statsByType(uint8_t type, EbStat& out);
+
+uint8_t  eb_ringLen(uint8_t producer);
+uint8_t  eb_ringUsed(uint8_t producer);
+uint8_t  eb_ringHighWater(uint8_t producer);
+uint16_t eb_ringDrops(uint8_t producer);
+uint16_t eb_ctrlCoalesced();    // control values overwritten before delivery
+
+// PROGMEM names for the DEBUG page / serial
+const char* eb_producerName(uint8_t producer);
+const char* eb_sourceName(uint8_t src);
+const char* eb_typeName(uint8_t type);
+
+// Serial table of everything above
+void eb_statsDump();
+#else
+inline void eb_statsPoll() {}
+inline void eb_statsReset() {}
+inline void eb_statsDump() {}
+#endif
 
 
 #endif // EVENT_BUS_H
\ No newline at end of file
@@ -7,6 +7,11 @@
 #include "input_codes.h"
 
 
+// Subscriber callback. Subscriptions are the PROGMEM ROUTES table in
+// event_router.cpp: one handler list per (source, type), so a lookup costs
+// the same however many sources exist.
+typedef void (*EventHandler)(const Event& e);
+
 // Pump all pending events and deliver to the current context
 // (or perform global actions like snap-to-live)
 void route_events();
@@ -0,0 +1,40 @@
+// ext_clock.h
+// External clock follower on PIN_EXT_CLOCK (INT4). Edges are timestamped
+// with the Timer5 timebase, the period is estimated with a median-of-3 +
+// IIR filter, and the Timer3 sequencer clock is slaved to it so it
+// interpolates SEQ_CLOCK_PPQN sub-ticks between edges. When edges stop,
+// the sequencer clock falls back to the internal tempo.
+#ifndef EXT_CLOCK_H
+#define EXT_CLOCK_H
+
+#include <stdint.h>
+
+// Incoming pulses per quarter note (4 = one pulse per 16th, 24 = DIN sync)
+#ifndef EXT_CLOCK_PPQN
+#define EXT_CLOCK_PPQN 4
+#endif
+
+// Consecutive plausible edges required before we follow the input
+#ifndef EXT_CLOCK_LOCK_EDGES
+#define EXT_CLOCK_LOCK_EDGES 3
+#endif
+
+// Edges closer than this are treated as bounce/glitches and ignored
+#ifndef EXT_CLOCK_MIN_PERIOD_US
+#define EXT_CLOCK_MIN_PERIOD_US 1000
+#endif
+
+// Gaps longer than this restart the period estimate from scratch
+#ifndef EXT_CLOCK_MAX_PERIOD_US
+#define EXT_CLOCK_MAX_PERIOD_US 2000000UL
+#endif
+
+void xclk_init();
+
+// True while the sequencer clock is slaved to the input
+bool xclk_locked();
+
+// Estimated incoming tempo in BPM (0 if no estimate yet)
+uint16_t xclk_bpm();
+
+#endif // EXT_CLOCK_H
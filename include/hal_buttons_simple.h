@@ -19,7 +19,18 @@ FN_BACK = 5
 };
 
 
+// Timer0 compare-B samples the function-key port every BTN_SAMPLE_DIV
+// overflows (~1.02 ms each); a key flips after 4 agreeing samples.
+#ifndef BTN_SAMPLE_DIV
+#define BTN_SAMPLE_DIV 4
+#endif
+
 void hal_buttons_setup();
+
+// Task the sampler wakes on a debounced edge (register it TASK_ON_DEMAND)
+void hal_buttons_setTask(int8_t taskId);
+
+// Publish the debounced edges; returns at once when there are none
 void hal_buttons_poll();
 
 
@@ -0,0 +1,57 @@
+// latency_trace.h
+// Input-to-output latency tracer. Every event carries its push stamp
+// (eb_popStamped); the router reports when it routed and handled it, the
+// display task when the frame showing it has been fully sent. Each path
+// is measured from the push and kept as a profiler-style histogram.
+// Compiles away with the profiler (release builds carry no cost).
+#ifndef LATENCY_TRACE_H
+#define LATENCY_TRACE_H
+
+#include <stdint.h>
+#include "config.h"
+#include "profiler.h"
+#include "event_bus.h"
+
+#ifndef LAT_TRACE
+#define LAT_TRACE PROF_ENABLED
+#endif
+#if LAT_TRACE && !PROF_ENABLED
+#error "LAT_TRACE needs PROF_ENABLED (it shares the profiler's histograms)"
+#endif
+
+enum LatPath : uint8_t {
+  LAT_KEY_ROUTE = 0,   // key edge pushed → popped by the router
+  LAT_KEY_HANDLE,      // key edge pushed → context handler returned
+  LAT_KEY_FRAME,       // key edge pushed → frame showing it fully sent
+  LAT_CTRL_ROUTE,      // pot/control pushed → popped (includes coalescing wait)
+  LAT_CLOCK_ROUTE,     // clock tick/sync pushed (ISR) → popped
+  LAT_PATH_COUNT
+};
+
+#if LAT_TRACE
+
+// Trace points, all on the main loop. pushedAt is the stamp from eb_popStamped().
+void lat_routed(const Event& e, uint32_t pushedAt);
+void lat_handled(const Event& e, uint32_t pushedAt);
+void lat_frameBegin();     // a draw() is about to run
+void lat_frameFlushed();   // nothing left to send (cheap no-op when idle)
+
+void lat_reset();
+const ProfStat* lat_path(uint8_t path);
+const char* lat_pathName(uint8_t path);   // PROGMEM string
+
+// Serial table with histograms
+void lat_dump();
+
+#else  // tracer off → compile away
+
+inline void lat_routed(const Event&, uint32_t) {}
+inline void lat_handled(const Event&, uint32_t) {}
+inline void lat_frameBegin() {}
+inline void lat_frameFlushed() {}
+inline void lat_reset() {}
+inline void lat_dump() {}
+
+#endif // LAT_TRACE
+
+#endif // LATENCY_TRACE_H
@@ -14,6 +14,11 @@ private:
   // working copy
   uint8_t maxPct;
   bool invert;
+  // value text, rebuilt only when the working copy changes
+  void refreshText();
+  char pctText[5];
+  char invText[4];
+  char uniText[9];
 };
 
 extern DisplayOptionsContext displayOptionsContext;
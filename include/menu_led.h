@@ -15,6 +15,11 @@ private:
   uint8_t brightness;   // 0..255
   uint8_t hitIndex;     // index into preset table
   uint8_t stepIndex;    // index into preset table
+  // value text, rebuilt only when the working copy changes
+  void refreshText();
+  char pctText[5];
+  char hitText[8];      // longest preset name is 7
+  char stepText[8];
 };
 
 extern LedOptionsContext ledOptionsContext;
@@ -18,6 +18,14 @@
 #define MENU_LIVE_H
 
 #include "object_classes.h"
+#include "display_st7920.h"
+
+// 1 = keep the grid as a retained bitmap, repaint only changed cells and
+// copy it into the frame (with the full buffer the frame itself is the
+// bitmap); 0 = draw every cell with drawBox/drawFrame
+#ifndef LIVE_GRID_BITMAP
+#define LIVE_GRID_BITMAP 1
+#endif
 
 class LiveModeContext : public ContextObject {
 public:
@@ -29,10 +37,10 @@ public:
 
   void draw(void* gfx) override;          // draws grid
   void handleInput(int input) override;   // reacts to hardware -> mapped inputs
-  void update(void* gfx) override;        // advance playhead, blink, etc.
+  void update(void* gfx) override;        // follow clock playhead
 
-  // Simple grid state (1 = active step)
-  bool steps[ROWS][COLS];
+  // Simple grid state (bit c of row r = active step)
+  uint8_t steps[ROWS];
   uint8_t cursorCol = 0;
   uint8_t cursorRow = 0;
   uint8_t playhead  = 0;
@@ -43,8 +51,49 @@ public:
   void nextColumn();
 
 private:
-  // tiny blink timer
-  uint16_t tick = 0;
+  // Toggles not yet in the sequencer's working copy (bit c = column)
+  uint8_t seqCells[ROWS];
+  static_assert(COLS <= 8, "seqCells holds one bit per column");
+  void flushEdits();
+
+  // Grid geometry (pixels)
+  static const uint8_t CELL  = 5;              // cell size
+  static const uint8_t PITCH = CELL + 1;       // cell + spacing
+  static const uint8_t OFF_X = 10;             // top-left of cell (0,0)
+  static const uint8_t OFF_Y = 2;
+
+#if LIVE_GRID_BITMAP
+  // Bitmap covers the cursor frame (1 px outside) down to the last
+  // playhead line; x is byte-aligned so rows copy straight into the frame.
+  static const uint8_t BMP_X     = (OFF_X - 1) & ~7;
+  static const uint8_t BMP_Y     = OFF_Y - 1;
+  static const uint8_t BMP_W     = ((OFF_X + COLS * PITCH - BMP_X) + 7) & ~7;
+  static const uint8_t BMP_H     = OFF_Y + ROWS * PITCH + 1 - BMP_Y;
+  static const uint8_t BMP_BYTES = BMP_W / 8;
+
+#if DISP_FULL_BUFFER
+  // U8g2's frame buffer keeps the grid between frames, so cells are
+  // painted straight into it instead of into a copy of our own
+  uint8_t* frame = nullptr;         // set by draw()
+  uint32_t frameNo = 0;             // disp_frameCount() after our last frame
+#else
+  uint8_t bmp[BMP_H * BMP_BYTES];   // 1 bit per pixel, MSB = leftmost
+#endif
+  uint8_t dirtyCells[ROWS];         // bit c = cell (r,c) needs repainting
+  static_assert(COLS <= 8, "dirtyCells holds one bit per column");
+  bool    bmpValid = false;
+  uint8_t shownCursorRow = 0, shownCursorCol = 0, shownPlayhead = 0;
+
+  bool pixelAt(int px, int py) const;
+  void paintRect(int x0, int y0, int x1, int y1);
+  void paintCell(uint8_t r, uint8_t c);
+  void paintPlayhead(uint8_t col);
+  uint8_t* bmpRow(int y);
+  void syncBitmap();
+#if !DISP_FULL_BUFFER
+  void blit(void* gfx) const;
+#endif
+#endif
 };
 
 extern LiveModeContext liveModeContext;
@@ -36,6 +36,9 @@ public:
   const char* const* subcontextNames;  // pointer to table of const char*
   uint8_t subcontextCount;
 
+  // Screen content changed since the last frame; main loop only draws when set.
+  bool dirty;
+
   ContextObject(const char* name_in,
                 const char* parent_in,
                 const char* const* subs_in,
@@ -43,12 +46,16 @@ public:
     : BaseObject(name_in),
       parentName(parent_in),
       subcontextNames(subs_in),
-      subcontextCount(count_in) {}
+      subcontextCount(count_in),
+      dirty(true) {}
 
   virtual void draw(void* /*gfx*/) {}       // Accepts U8G2* or similar
   virtual void handleInput(int /*input*/) {}
   virtual void update(void* /*gfx*/) {}
   virtual void output(int /*signal*/) {}
+
+  // Request a redraw on the next frame slot (cheap; safe to call repeatedly).
+  void invalidate() { dirty = true; }
 };
 
 class MenuObject : public ContextObject {
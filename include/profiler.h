@@ -0,0 +1,88 @@
+// profiler.h
+// Lightweight per-stage loop profiler on the Timer5 timebase.
+// Records min/avg/max and a coarse histogram for each loop stage and for
+// each context's draw(). Compiles away completely when PROF_ENABLED is 0
+// (default: follows DEBUG_SERIAL, so release builds carry no cost).
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include "config.h"
+
+#ifndef PROF_ENABLED
+#define PROF_ENABLED DEBUG_SERIAL
+#endif
+
+// Contexts with a draw() row, taken in the order they first draw; the rest
+// go unrecorded. A debug session visits a handful of the 20 pages.
+#ifndef PROF_CTX_SLOTS
+#define PROF_CTX_SLOTS 6
+#endif
+
+class ContextObject;
+
+enum ProfStage : uint8_t {
+  PROF_BUTTONS = 0,   // hal_buttons_poll() + twi_poll() + btnmx_poll()
+  PROF_BACKLIGHT,     // hal_backlight_poll()
+  PROF_ROUTE,         // route_events()
+  PROF_UPDATE,        // ctx->update()
+  PROF_DRAW,          // ctx->draw()
+  PROF_LOOP,          // whole loop() pass
+  PROF_STAGE_COUNT
+};
+
+// Histogram bins, powers of 4 from 32 us: <32 <128 <512 <2k <8k <32k <128k, rest
+#define PROF_HIST_BINS 8
+#define PROF_HIST_LEGEND "hist <32 <128 <512 <2k <8k <32k <128k >="
+
+struct ProfStat {
+  uint16_t minUs;     // saturates at 65535
+  uint16_t maxUs;
+  uint32_t sumUs;
+  uint16_t count;
+  uint8_t  hist[PROF_HIST_BINS];   // halved together when one saturates
+};
+
+#if PROF_ENABLED
+
+#include "timebase.h"
+
+void prof_record(uint8_t stage, uint32_t us);
+void prof_recordContext(const ContextObject* ctx, uint32_t us);
+void prof_reset();
+
+// Fold one sample into a stat / print it as a serial row (also used by
+// the latency tracer)
+void prof_statAdd(ProfStat& s, uint32_t us);
+void prof_dumpRow(const char* name, const ProfStat& s);
+
+// Read access for the DEBUG page (null if out of range / not recorded /
+// no slot left)
+const ProfStat* prof_stage(uint8_t stage);
+const ProfStat* prof_context(uint8_t registryIndex);
+const char* prof_stageName(uint8_t stage);   // PROGMEM string
+
+// Serial table of all stages and contexts
+void prof_dump();
+
+// Time one statement into a stage (and, for PROF_RUN_CTX, into ctx's row)
+#define PROF_RUN(stage, stmt) do { \
+    const uint32_t _prof_t0 = tb_now(); stmt; \
+    prof_record((stage), tb_to_us(tb_now() - _prof_t0)); \
+  } while (0)
+#define PROF_RUN_CTX(stage, ctx, stmt) do { \
+    const uint32_t _prof_t0 = tb_now(); stmt; \
+    const uint32_t _prof_us = tb_to_us(tb_now() - _prof_t0); \
+    prof_record((stage), _prof_us); prof_recordContext((ctx), _prof_us); \
+  } while (0)
+
+#else  // profiler off → compile away
+
+inline void prof_reset() {}
+inline void prof_dump() {}
+#define PROF_RUN(stage, stmt)          do { stmt; } while (0)
+#define PROF_RUN_CTX(stage, ctx, stmt) do { stmt; } while (0)
+
+#endif // PROF_ENABLED
+
+#endif // PROFILER_H
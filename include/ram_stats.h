@@ -0,0 +1,23 @@
+// ram_stats.h
+// Static RAM and stack headroom. .data + .bss end at __heap_start and the
+// stack grows down from RAMEND toward the heap, so the gap between the two
+// is all that is left. ram_paint() fills that gap with a pattern at boot;
+// ram_minFree() scans for the lowest point the stack has reached since.
+// Loop side only (the scan walks up to a few KB).
+#ifndef RAM_STATS_H
+#define RAM_STATS_H
+
+#include <stdint.h>
+
+// Bytes below the caller's frame left unpainted
+#ifndef RAM_PAINT_GUARD
+#define RAM_PAINT_GUARD 32
+#endif
+
+void ram_paint();          // first thing in setup()
+uint16_t ram_static();     // .data + .bss, bytes
+uint16_t ram_free();       // heap end → stack pointer, now
+uint16_t ram_minFree();    // smallest gap since ram_paint()
+void ram_dump();           // all of the above over serial
+
+#endif // RAM_STATS_H
@@ -0,0 +1,35 @@
+// render_gate.h
+// Invalidation-driven frame pacing: draw only when the current context is
+// dirty, and never faster than RENDER_MIN_FRAME_MS.
+#ifndef RENDER_GATE_H
+#define RENDER_GATE_H
+
+#include <stdint.h>
+
+class ContextObject;
+
+// Minimum spacing between two pushed frames (33 ms ≈ 30 fps cap)
+#ifndef RENDER_MIN_FRAME_MS
+#define RENDER_MIN_FRAME_MS 33
+#endif
+
+// How often render_stats_poll() prints drawn/skipped counters (debug builds)
+#ifndef RENDER_STATS_MS
+#define RENDER_STATS_MS 5000
+#endif
+
+// Mark the current context dirty (global changes: settings, invert, etc.)
+void render_invalidate();
+
+// True when ctx is dirty and the frame cap has elapsed. Clears ctx->dirty and
+// counts the frame as drawn; otherwise counts the loop pass as skipped.
+bool render_frame_due(ContextObject* ctx);
+
+// Counters since boot
+uint32_t render_frames_drawn();
+uint32_t render_frames_skipped();
+
+// Periodic serial report of the counters (no-op when DEBUG_SERIAL is 0)
+void render_stats_poll();
+
+#endif // RENDER_GATE_H
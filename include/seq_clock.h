@@ -0,0 +1,66 @@
+// seq_clock.h
+// Hardware-timer sequencer clock (Timer3, CTC). Generates ticks at
+// SEQ_CLOCK_PPQN from a BPM value, publishes EVT_TICK_24PPQN on the
+// event bus and runs the sequencer engine (seq_tick) on every tick.
+#ifndef SEQ_CLOCK_H
+#define SEQ_CLOCK_H
+
+#include <stdint.h>
+
+// Internal tick resolution: 24 or 96 pulses per quarter note. 96 gives
+// swing and micro-timing a 1/24-step grid; 24 only a 1/6-step one.
+#ifndef SEQ_CLOCK_PPQN
+#define SEQ_CLOCK_PPQN 96
+#endif
+#if (SEQ_CLOCK_PPQN != 24) && (SEQ_CLOCK_PPQN != 96)
+#error "SEQ_CLOCK_PPQN must be 24 or 96"
+#endif
+
+// Ticks per sequencer step (steps are 16th notes)
+#define SEQ_TICKS_PER_STEP (SEQ_CLOCK_PPQN / 4)
+
+// Tempo range accepted by clk_set_bpm()
+#ifndef SEQ_BPM_MIN
+#define SEQ_BPM_MIN 20
+#endif
+#ifndef SEQ_BPM_MAX
+#define SEQ_BPM_MAX 300
+#endif
+#ifndef SEQ_BPM_DEFAULT
+#define SEQ_BPM_DEFAULT 120
+#endif
+
+// Configure Timer3 (stopped). Call once from setup().
+void clk_init();
+
+// Tempo; takes effect on the next tick without resetting phase
+void clk_set_bpm(uint16_t bpm);
+uint16_t clk_get_bpm();
+
+// Transport. Start rewinds the pattern; first step plays on the first tick.
+void clk_start();
+void clk_stop();
+bool clk_running();
+
+// Ticks since clk_start() and the current pattern step (ISR-updated)
+uint32_t clk_ticks();
+uint8_t clk_position();
+
+// --- External sync (ext_clock) ---
+// Called from the edge ISR with the filtered edge period (timebase ticks).
+// Slaves Timer3 to the edges: ticksPerEdge sub-ticks are spread evenly
+// over one period and the phase is realigned on every edge. If no edge
+// arrives for two periods the clock drops back to the internal tempo.
+void clk_extEdgeFromISR(uint32_t edgePeriodTb, uint8_t ticksPerEdge);
+bool clk_following();
+
+// Loop side of the loss check: drops the lock once the last edge is three
+// edge periods old. Covers a stopped transport, where the Timer3 ISR that
+// normally notices is off.
+void clk_poll();
+
+// Loop task to trigger whenever a tick is published, so the events it
+// carries are delivered ahead of lower-priority work (see LoopManager.h)
+void clk_setTickTask(int8_t taskId);
+
+#endif // SEQ_CLOCK_H
@@ -1,7 +1,194 @@
-// core.h
+// sequencer_core.h
+// Pattern data and the real-time engine. seq_tick() runs from the clock
+// ISR on every tick. Each track keeps its own position, length, rate and
+// direction, advanced by a per-track tick countdown. A little before each
+// of its step boundaries a track resolves the coming step byte (trigger,
+// velocity, gate length, probability), offsets it by swing and
+// micro-timing, and drops the gate on and off into the timing wheel; the
+// wheel hands them to the output hook on their tick. Per-tick work is a
+// countdown per track plus at most one step resolve per track.
 #pragma once
 #include <stdint.h>
-struct Track { bool mute=false; uint8_t steps[16]; }; // velocity/gate or on/off
-struct Pattern { Track trk[10]; uint8_t length=16; uint8_t pos=0; };
-void seq_reset(Pattern& p);
-void seq_tick(Pattern& p); // advance pos
\ No newline at end of file
+#include "config.h"
+#include "profiler.h"
+#include "seq_clock.h"
+
+// Step byte: vvvv ggpp
+//   v  velocity level 0..15 (0 = rest); output velocity = v * 8 + 7
+//   g  gate length as a fraction of the step (SEQ_GATE_*)
+//   p  probability (SEQ_PROB_*)
+#define SEQ_STEP_VEL_SHIFT 4
+#define SEQ_STEP_VEL_MASK  0xF0
+#define SEQ_STEP_GATE_SHIFT 2
+#define SEQ_STEP_GATE_MASK 0x0C
+#define SEQ_STEP_PROB_MASK 0x03
+
+enum SeqGate : uint8_t { SEQ_GATE_25 = 0, SEQ_GATE_50, SEQ_GATE_75, SEQ_GATE_TIE };   // TIE = whole step
+enum SeqProb : uint8_t { SEQ_PROB_100 = 0, SEQ_PROB_75, SEQ_PROB_50, SEQ_PROB_25 };
+
+constexpr uint8_t seqStep(uint8_t vel, uint8_t gate, uint8_t prob) {
+  return (uint8_t)((vel << SEQ_STEP_VEL_SHIFT) | ((gate & 3) << SEQ_STEP_GATE_SHIFT) | (prob & 3));
+}
+
+// What a plain grid toggle writes
+#ifndef SEQ_STEP_DEFAULT
+#define SEQ_STEP_DEFAULT seqStep(12, SEQ_GATE_50, SEQ_PROB_100)
+#endif
+
+// ---- Polymeter ----
+// Track rate relative to the 16th-note step (period in clock ticks, see
+// RATE_PERIOD); 0 = X1 so a cleared pattern plays straight 16ths
+enum SeqRate : uint8_t {
+  SEQ_RATE_X1 = 0, SEQ_RATE_X2, SEQ_RATE_X3, SEQ_RATE_X4, SEQ_RATE_X3_2, SEQ_RATE_X3_4,
+  SEQ_RATE_D2, SEQ_RATE_D3, SEQ_RATE_D4, SEQ_RATE_D8, SEQ_RATE_COUNT
+};
+enum SeqDir : uint8_t { SEQ_DIR_FWD = 0, SEQ_DIR_REV, SEQ_DIR_PINGPONG, SEQ_DIR_RANDOM, SEQ_DIR_COUNT };
+
+// Per-track loop: length 0 follows the pattern length, else 1..NUM_STEPS
+struct SeqTrackCfg { uint8_t length; uint8_t rate; uint8_t dir; };
+
+struct Track {
+  bool mute=false;
+  uint8_t length=0, rate=SEQ_RATE_X1, dir=SEQ_DIR_FWD;   // SeqTrackCfg
+  uint8_t steps[NUM_STEPS];   // step bytes, see above
+  int8_t  nudge[NUM_STEPS];   // micro-timing in ticks, ±SEQ_NUDGE_MAX
+};
+// length/pos: the bar (the playhead and the 16th-note grid tracks follow at X1)
+struct Pattern { Track trk[NUM_INSTR]; uint8_t length=NUM_STEPS; uint8_t pos=0; };
+static_assert(NUM_INSTR <= 16, "seq_gates() and the packed planes hold one bit per track");
+static_assert(NUM_STEPS <= 64, "track lengths go up to 64 steps");
+
+// Packed layout: step-major bitplanes, one bit per track in each word, so
+// a whole step's trigger set is trig[pos] & ~mute. Velocity collapses to
+// normal/accent; gate, probability and the normal velocity come from one
+// voice byte per track (a step byte), and micro-timing is per step for
+// all tracks. 114 bytes against Pattern's 362.
+struct PackedPattern {
+  uint16_t trig[NUM_STEPS];     // bit t = track t plays on this step
+  uint16_t accent[NUM_STEPS];   // bit t = played at SEQ_ACCENT_LEVEL
+  int8_t   nudge[NUM_STEPS];    // micro-timing in ticks, every track
+  uint16_t mute = 0;
+  uint8_t  voice[NUM_INSTR];    // step byte used for every hit of the track
+  uint8_t  trkLength[NUM_INSTR];  // SeqTrackCfg.length
+  uint8_t  trkMode[NUM_INSTR];    // rate | dir << 4
+  uint8_t  length = NUM_STEPS;
+  uint8_t  pos = 0;
+};
+
+#ifndef SEQ_ACCENT_LEVEL
+#define SEQ_ACCENT_LEVEL 15
+#endif
+
+// Layout the clock plays: 0 = Pattern (step bytes), 1 = PackedPattern
+#ifndef SEQ_PACKED
+#define SEQ_PACKED 0
+#endif
+#if SEQ_PACKED
+typedef PackedPattern SeqPattern;
+#else
+typedef Pattern SeqPattern;
+#endif
+
+// Step access for either layout. Packed writes are lossy: a hit sets the
+// trigger bit, accent when its level is above the voice's, and the first
+// hit on an empty track seeds the voice.
+uint8_t seq_getStep(const Pattern& p, uint8_t track, uint8_t step);
+uint8_t seq_getStep(const PackedPattern& p, uint8_t track, uint8_t step);
+void seq_setStep(Pattern& p, uint8_t track, uint8_t step, uint8_t v);
+void seq_setStep(PackedPattern& p, uint8_t track, uint8_t step, uint8_t v);
+SeqTrackCfg seq_getTrackCfg(const Pattern& p, uint8_t track);
+SeqTrackCfg seq_getTrackCfg(const PackedPattern& p, uint8_t track);
+void seq_setTrackCfg(Pattern& p, uint8_t track, const SeqTrackCfg& cfg);
+void seq_setTrackCfg(PackedPattern& p, uint8_t track, const SeqTrackCfg& cfg);
+void seq_pack(const Pattern& in, PackedPattern& out);
+void seq_unpack(const PackedPattern& in, Pattern& out);
+
+// ---- Groove ----
+// Swing delays every other step of a track by (percent - 50) % of two of
+// its steps: 50 = straight, 66 ~ triplet feel, 75 = half a step. A track
+// swing of 0 follows the global one.
+#define SEQ_SWING_MIN 50
+#define SEQ_SWING_MAX 75
+void seq_setSwing(uint8_t percent);
+uint8_t seq_getSwing();
+void seq_setTrackSwing(uint8_t track, uint8_t percent);
+uint8_t seq_getTrackSwing(uint8_t track);
+
+// Micro-timing: a signed tick offset per step (per track for Pattern, per
+// step for PackedPattern), clamped to half a 16th either way. Steps are
+// resolved that far ahead (at most half the track's own step) so a
+// negative nudge can still play early.
+#define SEQ_NUDGE_MAX  (SEQ_TICKS_PER_STEP / 2)
+#define SEQ_LEAD_TICKS SEQ_NUDGE_MAX
+int8_t seq_getNudge(const Pattern& p, uint8_t track, uint8_t step);
+int8_t seq_getNudge(const PackedPattern& p, uint8_t track, uint8_t step);
+void seq_setNudge(Pattern& p, uint8_t track, uint8_t step, int8_t ticks);
+void seq_setNudge(PackedPattern& p, uint8_t track, uint8_t step, int8_t ticks);
+
+// Output hook, called from the clock ISR: velocity 1..127 opens the
+// track's gate, 0 closes it. Must be short (no Serial, no waiting).
+typedef void (*SeqOutFn)(uint8_t track, uint8_t velocity);
+void seq_setOutput(SeqOutFn fn);
+
+void seq_reset();                 // rewind; next tick plays step 0
+void seq_tick(uint8_t sub);       // every clock tick, sub = tick within step
+void seq_allOff();                // close every open gate (transport stop)
+const SeqPattern& seq_pattern();  // pattern the clock ISR is playing
+
+// ---- Double-buffered edits ----
+// The ISR plays one buffer while the loop edits the other. seq_commit()
+// asks for a swap at the next quantization point; the ISR makes it by
+// flipping one index byte, SEQ_LEAD_TICKS before that boundary so its
+// steps already resolve from the new buffer. It never sees a half-edited
+// pattern and never waits on the loop. Until the swap lands the working
+// copy is frozen (seq_edit() returns nullptr); the next seq_edit() starts
+// from a copy of what is playing by then. Loop only.
+enum SeqQuant : uint8_t { SEQ_QUANT_STEP = 0, SEQ_QUANT_BEAT, SEQ_QUANT_BAR };
+SeqPattern* seq_edit();
+void seq_commit(uint8_t quant);   // swaps at once while the clock is stopped
+bool seq_swapPending();
+void seq_landSwap();              // take a pending swap now (transport stop)
+
+// Where UI edits land
+#ifndef SEQ_EDIT_QUANT
+#define SEQ_EDIT_QUANT SEQ_QUANT_BAR
+#endif
+
+// Tracks whose gate is open (bit = track)
+uint16_t seq_gates();
+
+// Step each track is playing (its own position)
+uint8_t seq_trackPos(uint8_t track);
+
+// Engine cost per clock tick (ISR time) as a profiler row
+#ifndef SEQ_STATS
+#define SEQ_STATS PROF_ENABLED
+#endif
+#if SEQ_STATS && !PROF_ENABLED
+#error "SEQ_STATS needs PROF_ENABLED (it shares the profiler's histograms)"
+#endif
+
+// Ticks that took longer than this count as overruns
+#ifndef SEQ_TICK_BUDGET_US
+#define SEQ_TICK_BUDGET_US 100
+#endif
+
+#if SEQ_STATS
+void seq_statsReset();
+void seq_statsDump();
+#else
+inline void seq_statsReset() {}
+inline void seq_statsDump() {}
+#endif
+
+// Serial microbenchmark: bytes per pattern, the trigger-word read the
+// engine does per grid step and the full engine tick, in both layouts on
+// the same random pattern (clock must be stopped)
+#ifndef SEQ_BENCH
+#define SEQ_BENCH DEBUG_SERIAL
+#endif
+#if SEQ_BENCH
+void seq_benchmark();
+#else
+inline void seq_benchmark() {}
+#endif
@@ -8,6 +8,7 @@ struct Settings {
   uint8_t ws_brightness;     // 0..255
   uint32_t ws_hit_color;     // 0xRRGGBB
   uint32_t ws_step_color;    // 0xRRGGBB
+  uint16_t tempo_bpm;        // internal clock tempo
 };
 
 // Initialize settings (load from EEPROM or create defaults)
@@ -16,9 +17,15 @@ void settings_init();
 // Access current settings (live copy)
 Settings& settings_get();
 
-// Save current settings to EEPROM
+// Queue current settings for writing to EEPROM (written by settings_service)
 void settings_save();
 
+// Storage task: writes at most one changed EEPROM byte per call (~3.4 ms)
+void settings_service();
+
+// True while a queued save hasn't fully reached EEPROM
+bool settings_save_pending();
+
 // Apply settings to subsystems that care (e.g., backlight)
 void settings_apply_runtime();
 
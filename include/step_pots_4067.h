@@ -1,5 +1,8 @@
 // step_pots_4067.h
 #pragma once
 #include <stdint.h>
+
+// Select/enable pins of the CD4067; the pots themselves are scanned by
+// adc_scan (channels ADC_CH_STEP0..+15, EVT_POT_MOVE a = pot, b = value/4)
 void stepPots_init();
-uint16_t stepPots_read(uint8_t idx); // 0..15 → 0..1023
\ No newline at end of file
+uint16_t stepPots_value(uint8_t idx);// last scanned value 0..1023
@@ -0,0 +1,24 @@
+// timebase.h
+// Free-running 32-bit timebase on Timer5 (F_CPU/8 → 0.5 us per tick).
+// Used for edge timestamps and short interval measurements.
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <stdint.h>
+
+#define TB_TICKS_PER_US 2
+
+// Start Timer5 in normal mode with overflow extension. Call once from setup().
+void tb_init();
+
+// Current time in ticks. tb_now() from the main loop (masks interrupts
+// only across the 16-bit counter read), tb_nowISR() when they're already
+// disabled (inside an ISR).
+uint32_t tb_now();
+uint32_t tb_nowISR();
+
+// Tick/us helpers (durations only)
+inline uint32_t tb_to_us(uint32_t ticks) { return ticks / TB_TICKS_PER_US; }
+inline uint32_t tb_from_us(uint32_t us)  { return us * TB_TICKS_PER_US; }
+
+#endif // TIMEBASE_H
@@ -0,0 +1,43 @@
+// timing_wheel.h
+// Sub-step scheduler for the sequencer engine. A ring of SEQ_WHEEL_SLOTS
+// clock ticks, each slot the head of a singly linked list of jobs drawn
+// from a fixed pool: scheduling pushes onto the target slot's list,
+// wheel_tick() detaches the current slot's list whole and runs it. Both
+// are O(1) per job and never scan. ISR-only (the clock ISR owns it);
+// wheel_clear() may be called from the loop.
+#ifndef TIMING_WHEEL_H
+#define TIMING_WHEEL_H
+
+#include <stdint.h>
+
+// Ticks of horizon (power of two); jobs go at most SEQ_WHEEL_SLOTS-1 ahead.
+// 128 holds a whole-step gate on a half-rate track at 96 PPQN; longer
+// gates are cut to the horizon.
+#ifndef SEQ_WHEEL_SLOTS
+#define SEQ_WHEEL_SLOTS 128
+#endif
+
+// Pending jobs across the whole wheel (< 255)
+#ifndef SEQ_WHEEL_JOBS
+#define SEQ_WHEEL_JOBS 64
+#endif
+
+// vel 1..127 = gate on, 0 = gate off; gen tells a note's off from a
+// newer note's on the same track
+typedef void (*WheelFire)(uint8_t track, uint8_t vel, uint8_t gen);
+
+// Queue a job delay ticks from the current one (0 = still this tick, if
+// called before wheel_tick). False if the pool is empty or delay too far.
+bool wheel_schedule(uint8_t delay, uint8_t track, uint8_t vel, uint8_t gen);
+
+// Run the current slot's jobs, then move to the next tick
+void wheel_tick(WheelFire fire);
+
+// Drop every pending job
+void wheel_clear();
+
+uint8_t  wheel_pending();   // jobs queued now
+uint8_t  wheel_highWater(); // most ever queued at once
+uint16_t wheel_drops();     // jobs refused (pool empty / too far ahead)
+
+#endif // TIMING_WHEEL_H
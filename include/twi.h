@@ -0,0 +1,80 @@
+// twi.h
+// Interrupt-driven I2C master. Callers queue small transactions ("jobs":
+// write up to TWI_TX_MAX bytes, then optionally read after a repeated
+// start) and keep running; TWI_vect walks each job through the bus and
+// chains the next one. Completion callbacks run from twi_poll() on the
+// main loop. A job that doesn't finish within TWI_TIMEOUT_MS is aborted,
+// the bus is recovered, and an EVT_BUS_ERROR is published (SRC_I2C).
+#ifndef TWI_H
+#define TWI_H
+
+#include <stdint.h>
+
+// Queued jobs (power of two; one slot stays free). A 6-row bank scan is
+// 7 jobs, so two banks go out back to back.
+#ifndef TWI_QUEUE_LEN
+#define TWI_QUEUE_LEN 16
+#endif
+
+// Bytes written per job, register address included (copied at submit)
+#ifndef TWI_TX_MAX
+#define TWI_TX_MAX 4
+#endif
+
+#ifndef TWI_HZ
+#define TWI_HZ 400000UL
+#endif
+
+#ifndef TWI_TIMEOUT_MS
+#define TWI_TIMEOUT_MS 5
+#endif
+
+enum TwiStatus : uint8_t {
+  TWI_OK = 0,
+  TWI_PENDING,       // queued or on the bus
+  TWI_NACK_ADDR,     // nobody answered (device missing)
+  TWI_NACK_DATA,
+  TWI_ARB_LOST,
+  TWI_BUS_ERROR,     // illegal START/STOP seen on the bus
+  TWI_TIMEOUT        // no progress within TWI_TIMEOUT_MS; bus was reset
+};
+
+// Runs on the main loop (from twi_poll). rx, if any, is filled by now.
+typedef void (*TwiDone)(uint8_t status, uint8_t tag);
+
+// Enable the TWI peripheral with internal pull-ups. Call once from setup().
+void twi_init(uint32_t hz);
+
+// Task woken when jobs complete or need a timeout check
+// (register it TASK_ON_DEMAND and call twi_poll() from it)
+void twi_setTask(int8_t taskId);
+
+// Queue a job (main loop only). txLen = 0 and rxLen = 0 probes the
+// address. rx must stay valid until done runs. False if the queue is full.
+bool twi_submit(uint8_t addr, const uint8_t* tx, uint8_t txLen,
+                uint8_t* rx, uint8_t rxLen, TwiDone done, uint8_t tag);
+
+inline bool twi_writeReg(uint8_t addr, uint8_t reg, uint8_t val, TwiDone done, uint8_t tag) {
+  const uint8_t tx[2] = { reg, val };
+  return twi_submit(addr, tx, 2, nullptr, 0, done, tag);
+}
+inline bool twi_readRegs(uint8_t addr, uint8_t reg, uint8_t* rx, uint8_t n, TwiDone done, uint8_t tag) {
+  return twi_submit(addr, &reg, 1, rx, n, done, tag);
+}
+
+// Free job slots / nothing queued or on the bus
+uint8_t twi_free();
+bool twi_idle();
+
+// Retire finished jobs (callbacks, error events) and enforce timeouts
+void twi_poll();
+
+// Run one job to completion, polling meanwhile; for one-shot diagnostics
+// only. Bounded by TWI_TIMEOUT_MS per job ahead of it in the queue.
+uint8_t twi_runSync(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen);
+inline bool twi_probeSync(uint8_t addr) { return twi_runSync(addr, nullptr, 0, nullptr, 0) == TWI_OK; }
+
+// Jobs that ended in a bus error or timeout since boot
+uint16_t twi_errorCount();
+
+#endif // TWI_H
@@ -50,28 +50,9 @@ inline void drawTitleWithLines(U8G2* gfx, const char* title, int y = 12, int gap
   if (rightBeg < W) gfx->drawHLine(rightBeg, lineY, W - rightBeg);
 }
 
-// Centered title with side lines (PROGMEM title).
-inline void drawTitleWithLines_P(U8G2* gfx, const char* titleP, int y = 12, int gapPx = 6) {
-  if (!gfx || !titleP) return;
-
-  char buf[24];
-  strncpy_P(buf, titleP, sizeof(buf) - 1);
-  buf[sizeof(buf) - 1] = '\0';
-
-  gfx->setFont(u8g2_font_6x13_tf);
-  const int W   = gfx->getDisplayWidth();
-  const int txt = gfx->getUTF8Width(buf);
-  int x = (W - txt) / 2; if (x < 0) x = 0;
-
-  gfx->drawStr(x, y, buf);
-
-  const int lineY   = y - 5;
-  const int leftEnd = x - gapPx;
-  const int rightBeg= x + txt + gapPx;
-
-  if (leftEnd > 0)  gfx->drawHLine(0,        lineY, leftEnd);
-  if (rightBeg < W) gfx->drawHLine(rightBeg, lineY, W - rightBeg);
-}
+// Centered title with side lines (PROGMEM title). Text and width come
+// from the retained layout cache (ui_draw.cpp).
+void drawTitleWithLines_P(U8G2* gfx, const char* titleP, int y = 12, int gapPx = 6);
 
 // Paged menu (RAM items).
 inline void drawMenuPaged(U8G2* gfx,
@@ -187,6 +168,38 @@ inline void drawMenuPagedP(U8G2* gfx,
   } while (gfx->nextPage());
 }
 
+// ---- Retained layout cache ----
+// Menus keep their copied strings, measured title and scrollbar geometry
+// between frames, keyed by the PROGMEM items table. The layout is rebuilt
+// only when the title, the item set or the visible window changes; a frame
+// is then just drawStr/drawBox from the cache.
+#ifndef UI_MENU_SLOTS
+#define UI_MENU_SLOTS 2    // menus kept at once (current + the one we came from)
+#endif
+#ifndef UI_TITLE_SLOTS
+#define UI_TITLE_SLOTS 4   // drawTitleWithLines_P titles kept at once
+#endif
+#define UI_TEXT_MAX 22     // 21 chars of 6x10 fill the 128 px row
+#define UI_ROWS_MAX 4
+
+// Paged menu, PROGMEM title and items, drawn from the layout cache.
+void drawMenuPagedP_P(U8G2* gfx,
+                      const char* titleP,
+                      const char* const* itemsP,
+                      uint8_t count,
+                      uint8_t selected,
+                      uint8_t rows = 4);
+
+// Option page: PROGMEM title and labels from the layout cache, RAM values
+// right-aligned. A nullptr value marks an action row ("> Save" when selected).
+// Callers keep the value text themselves and refresh it when it changes.
+void drawOptionRowsP_P(U8G2* gfx,
+                       const char* titleP,
+                       const char* const* labelsP,
+                       const char* const* values,
+                       uint8_t count,
+                       uint8_t selected);
+
 // Back-compat alias some files might call.
 inline void drawMenuPaged_P(U8G2* gfx,
                             const char* title,
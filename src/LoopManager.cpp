@@ -0,0 +1,122 @@
+// LoopManager.cpp
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "LoopManager.h"
+#include "timebase.h"
+#include "debug.h"
+
+static LoopTask loopTasks[MAX_TASKS];
+static uint8_t  loopTaskCnt = 0;
+
+int8_t registerLoopTask(const char* nameP, TaskFunc fn, uint16_t periodMs,
+                        uint8_t prio, uint16_t budgetUs) {
+  if (!fn || loopTaskCnt >= MAX_TASKS) return -1;
+  LoopTask& t = loopTasks[loopTaskCnt];
+  memset(&t, 0, sizeof(t));
+  t.nameP    = nameP;
+  t.fn       = fn;
+  t.periodMs = periodMs;
+  t.budgetUs = budgetUs;
+  t.prio     = prio;
+  t.nextDue  = millis();
+  return (int8_t)loopTaskCnt++;
+}
+
+void triggerLoopTask(int8_t id) {
+  if (id >= 0 && id < loopTaskCnt) loopTasks[id].triggered = 1;   // single byte store
+}
+
+void wakeLoopTaskIn(int8_t id, uint16_t ms) {
+  if (id < 0 || id >= loopTaskCnt || loopTasks[id].periodMs != TASK_ON_DEMAND) return;
+  LoopTask& t = loopTasks[id];
+  const unsigned long due = millis() + ms;
+  // Several callers may share a task: keep the earliest request
+  if (!t.wakePending || (long)(due - t.nextDue) < 0) t.nextDue = due;
+  t.wakePending = 1;
+}
+
+static inline bool isReady(const LoopTask& t, unsigned long now) {
+  if (t.triggered) return true;
+  if (t.periodMs == TASK_ON_DEMAND && !t.wakePending) return false;
+  return (long)(now - t.nextDue) >= 0;
+}
+
+// Triggered work is due immediately; periodic work by its release time
+static inline unsigned long deadlineOf(const LoopTask& t, unsigned long now) {
+  return t.triggered ? now : t.nextDue;
+}
+
+static void runTask(LoopTask& t, unsigned long now) {
+  t.triggered = 0;   // clear first so a trigger raised while running isn't lost
+  if (t.periodMs == TASK_ON_DEMAND && (long)(now - t.nextDue) >= 0) t.wakePending = 0;
+  const uint32_t t0 = tb_now();
+  t.fn();
+  const uint32_t us = tb_to_us(tb_now() - t0);
+
+  t.lastUs = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+  if (t.lastUs > t.maxUs) t.maxUs = t.lastUs;
+  if (us > t.budgetUs && t.overruns < 0xFFFF) t.overruns++;
+  t.runs++;
+
+  if (t.periodMs != 0 && t.periodMs != TASK_ON_DEMAND && (long)(now - t.nextDue) >= 0) {
+    t.nextDue += t.periodMs;
+    // Fell a whole period behind: drop the backlog instead of bursting
+    if ((long)(now - t.nextDue) >= 0) {
+      t.nextDue = now + t.periodMs;
+      if (t.misses < 0xFFFF) t.misses++;
+    }
+  }
+}
+
+void runLoopTasks() {
+  const unsigned long now = millis();
+  uint8_t ran = 0;   // bit per task already run in this pass
+
+  // Re-pick after every task so a trigger raised meanwhile (e.g. by the
+  // clock ISR) jumps ahead of any lower-priority work still pending.
+  for (;;) {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < loopTaskCnt; ++i) {
+      const LoopTask& t = loopTasks[i];
+      // A task runs once per pass unless re-triggered while we were busy
+      if (((ran & (1u << i)) && !t.triggered) || !isReady(t, now)) continue;
+      if (best < 0) { best = (int8_t)i; continue; }
+      const LoopTask& b = loopTasks[best];
+      if (t.prio < b.prio ||
+          (t.prio == b.prio && (long)(deadlineOf(t, now) - deadlineOf(b, now)) < 0)) {
+        best = (int8_t)i;
+      }
+    }
+    if (best < 0) break;
+    runTask(loopTasks[best], now);
+    ran |= (uint8_t)(1u << best);
+  }
+}
+
+uint8_t loopTaskCount() { return loopTaskCnt; }
+
+const LoopTask* loopTask(uint8_t id) {
+  return (id < loopTaskCnt) ? &loopTasks[id] : nullptr;
+}
+
+void resetLoopTaskStats() {
+  for (uint8_t i = 0; i < loopTaskCnt; ++i) {
+    LoopTask& t = loopTasks[i];
+    t.runs = t.overruns = t.misses = t.lastUs = t.maxUs = 0;
+  }
+}
+
+void dumpLoopTasks() {
+  DLLN("-- tasks --  name prio period budget runs over miss last max (us/ms)");
+  for (uint8_t i = 0; i < loopTaskCnt; ++i) {
+    const LoopTask& t = loopTasks[i];
+    char name[12];
+    strncpy_P(name, t.nameP, sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    char line[64];
+    snprintf_P(line, sizeof(line), PSTR("%-10s%2u%6u%7u%6u%5u%5u%6u%6u"),
+             name, (unsigned)t.prio, (unsigned)t.periodMs, (unsigned)t.budgetUs,
+             (unsigned)t.runs, (unsigned)t.overruns, (unsigned)t.misses,
+             (unsigned)t.lastUs, (unsigned)t.maxUs);
+    DPRINTLN(line);
+  }
+}
@@ -0,0 +1,120 @@
+// adc_scan.cpp
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "adc_scan.h"
+#include "event_bus.h"
+#include "debug.h"
+
+static_assert((ADC_OVERSAMPLE & (ADC_OVERSAMPLE - 1)) == 0 && ADC_OVERSAMPLE <= 16,
+              "ADC_OVERSAMPLE must be a power of two <= 16");
+static_assert(ADC_CH_COUNT <= EB_CONTROL_SLOTS, "pot channels must fit the control lane");
+
+#define MUX_NONE 0xFF
+
+// Scan order: ADC input (0..15) and 4067 channel (MUX_NONE = direct pin)
+struct ScanEntry { uint8_t logical, input, mux; };
+#define MUXED(i) { ADC_CH_STEP0 + (i), PIN_MUX_SIG - A0, (i) }
+static const ScanEntry SCAN[] PROGMEM = {
+#if USE_4067_STEPPOTS
+  MUXED(0),  MUXED(1),  MUXED(2),  MUXED(3),  MUXED(4),  MUXED(5),  MUXED(6),  MUXED(7),
+  MUXED(8),  MUXED(9),  MUXED(10), MUXED(11), MUXED(12), MUXED(13), MUXED(14), MUXED(15),
+#endif
+  { ADC_CH_INST0 + 0, PIN_INST_POT_1  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 1, PIN_INST_POT_2  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 2, PIN_INST_POT_3  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 3, PIN_INST_POT_4  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 4, PIN_INST_POT_5  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 5, PIN_INST_POT_6  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 6, PIN_INST_POT_7  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 7, PIN_INST_POT_8  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 8, PIN_INST_POT_9  - A0, MUX_NONE },
+  { ADC_CH_INST0 + 9, PIN_INST_POT_10 - A0, MUX_NONE },
+  { ADC_CH_BRIGHT,    PIN_BRIGHT_POT  - A0, MUX_NONE },
+};
+#undef MUXED
+static const uint8_t SCAN_LEN = sizeof(SCAN) / sizeof(SCAN[0]);
+
+#define ADCSRA_RUN (_BV(ADEN) | _BV(ADIE) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0))
+
+static volatile uint16_t s_value[ADC_CH_COUNT];   // accepted, 0..1023 (ISR writes)
+static volatile uint16_t s_sweeps = 0;
+static bool s_filled = false;                     // every channel accepted once
+
+// ISR-only scan position
+static uint8_t  s_pos = 0;
+static uint8_t  s_logical = 0;
+static int8_t   s_sample = -1;                    // -1 = settling conversion
+static uint16_t s_sum = 0;
+
+// Point the ADC (and the 4067, if muxed) at scan entry pos and start the
+// settling conversion (the 4067 select lines are set up by stepPots_init)
+static inline void selectEntry(uint8_t pos) {
+  const uint8_t input = pgm_read_byte(&SCAN[pos].input);
+  const uint8_t mux   = pgm_read_byte(&SCAN[pos].mux);
+  s_logical = pgm_read_byte(&SCAN[pos].logical);
+  if (mux != MUX_NONE) MUX_SEL_PORT = (uint8_t)((MUX_SEL_PORT & ~MUX_SEL_MASK) | (mux << MUX_SEL_SHIFT));
+  ADMUX  = (uint8_t)(_BV(REFS0) | (input & 0x07));
+  ADCSRB = (uint8_t)((ADCSRB & ~_BV(MUX5)) | ((input & 0x08) ? _BV(MUX5) : 0));
+  s_sample = -1;
+  s_sum = 0;
+  ADCSRA = ADCSRA_RUN | _BV(ADSC);
+}
+
+static void accept(uint8_t ch, uint16_t v) {
+  s_value[ch] = v;
+  if (ch == ADC_CH_BRIGHT) return;                // polled by the backlight
+  Event e;
+  e.type = EVT_POT_MOVE;
+  e.src  = SRC_POTS;
+  e.a    = ch;
+  e.b    = (uint8_t)(v >> 2);
+  eb_pushFrom(PROD_ADC_ISR, e);                   // coalesced: latest value per pot
+}
+
+ISR(ADC_vect) {
+  const uint16_t raw = ADC;
+  if (s_sample >= 0) s_sum += raw;                // first result after a switch is dropped
+  if (++s_sample < ADC_OVERSAMPLE) { ADCSRA = ADCSRA_RUN | _BV(ADSC); return; }
+
+  const uint16_t v = s_sum / ADC_OVERSAMPLE;
+  const uint16_t old = s_value[s_logical];
+  const uint16_t d = (v > old) ? v - old : old - v;
+  if (d > ADC_HYST || !s_filled) accept(s_logical, v);
+
+  if (++s_pos >= SCAN_LEN) {
+    s_pos = 0;
+    s_filled = true;
+    s_sweeps++;
+  }
+  selectEntry(s_pos);
+}
+
+void adc_init() {
+  // Analog-only pins: drop their digital input buffers
+  for (uint8_t i = 0; i < SCAN_LEN; ++i) {
+    const uint8_t input = pgm_read_byte(&SCAN[i].input);
+    if (input < 8) DIDR0 |= _BV(input);
+    else           DIDR2 |= _BV(input - 8);
+  }
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { selectEntry(0); }
+
+  // One sweep is ~15 ms at F_CPU/128; wait for it so callers can seed
+  // from adc_value() right away
+  const unsigned long t0 = millis();
+  while (adc_sweeps() == 0 && (millis() - t0) < ADC_FIRST_SWEEP_MS) {}
+  if (adc_sweeps() == 0) { DLLN("adc: no conversions, is ADC_vect firing?"); }
+}
+
+uint16_t adc_value(uint8_t ch) {
+  if (ch >= ADC_CH_COUNT) return 0;
+  uint16_t v;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { v = s_value[ch]; }
+  return v;
+}
+
+uint16_t adc_sweeps() {
+  uint16_t n;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { n = s_sweeps; }
+  return n;
+}
@@ -1,18 +1,15 @@
-#include <Wire.h>
 #include <SPI.h>
 #include <SD.h>
 #include "config.h"
 #include <Arduino.h>
 #include "config.h"
 #include "debug.h"
+#include "twi.h"
 
 void i2c_scan(){
 DL("I2C scan:");
-Wire.begin();
 for (uint8_t addr=1; addr<127; ++addr){
-Wire.beginTransmission(addr);
-uint8_t err = Wire.endTransmission();
-if(err==0){ DL(" - 0x"); DPRINTLN(addr, HEX); }
+if(twi_probeSync(addr)){ DL(" - 0x"); DPRINTLN(addr, HEX); }
 }
 }
 
@@ -26,7 +23,7 @@ while(true){
 File f = root.openNextFile();
 if(!f) break;
 DL(" "); DPRINT(f.name());
-if(f.isDirectory()) DL("/"); else DL("");
+if(f.isDirectory()) { DL("/"); } else { DL(""); }
 f.close();
 }
 root.close();
@@ -1,47 +1,295 @@
-// button_matrix.cpp (sketchy stub)
+// button_matrix.cpp
 #include <Arduino.h>
-#include <Wire.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 #include "config.h"
 #include "button_matrix.h"
+#include "event_bus.h"
+#include "LoopManager.h"
+#include "twi.h"
+#include "debug.h"
 
-// Using MCP23017: GPA=rows (outputs), GPB=cols (inputs with pullups)
-// 6 rows, 6 cols → 36 buttons, with per-key diodes to prevent ghosting.
-
-
-static inline void mcp_write(uint8_t reg, uint8_t val){ Wire.beginTransmission(I2C_ADDR_MCP);
-     Wire.write(reg);
-      Wire.write(val);
-       Wire.endTransmission(); }
-static inline uint8_t mcp_read(uint8_t reg){ Wire.beginTransmission(I2C_ADDR_MCP);
-     Wire.write(reg); Wire.endTransmission(false);
-      Wire.requestFrom((uint8_t)I2C_ADDR_MCP, (uint8_t)1);
-       return Wire.read(); }
-
-
-void btnmx_init(){
-Wire.begin();
-// IODIRA=rows outputs (lower 6 used), IODIRB=cols inputs
-mcp_write(0x00, 0x00); // IODIRA all outputs
-mcp_write(0x01, 0xFF); // IODIRB all inputs
-mcp_write(0x0D, 0xFF); // GPPUB pullups on B
-}
-
-
-uint32_t btnmx_read(){
-uint32_t bits=0; // we’ll pack 36 bits LSB..MSB
-for(uint8_t r=0; r<6; ++r){
-    uint8_t rowMask = (1<<r);
-        mcp_write(0x12, rowMask); // GPIOA set active row high
-        delayMicroseconds(50);
-    uint8_t cols = mcp_read(0x13); // GPIOB
-        cols = ~cols; // active high when pressed
-    for(uint8_t c=0; c<6; ++c){
-        uint8_t pressed = (cols>>c)&1;
-        uint8_t idx = r*6 + c; // 0..35
-        if(pressed) bits |= (1UL<<idx);
+// MCP23017 registers, IOCON.BANK = 0 (A/B interleaved)
+#define MCP_IODIRA   0x00
+#define MCP_IODIRB   0x01
+#define MCP_GPINTENB 0x05
+#define MCP_INTCONB  0x09
+#define MCP_IOCON    0x0A
+#define MCP_GPPUB    0x0D
+#define MCP_INTFB    0x0F
+#define MCP_GPIOA    0x12
+#define MCP_GPIOB    0x13
+
+#define IOCON_MIRROR 0x40   // INTA and INTB both report either port
+#define IOCON_ODR    0x04   // open-drain INT, so expanders share the line
+
+struct Bank {
+  uint8_t addr;
+  uint8_t rows, cols;       // GPA rows / GPB columns used, up to 8 each
+  uint8_t src;              // EventSource of its keys
+};
+
+static const Bank BANKS[] PROGMEM = {
+  { I2C_ADDR_MCP,   BTNMX_ROWS,   BTNMX_COLS,   SRC_MATRIX_A },
+#if BTNMX_BANKS > 1
+  { I2C_ADDR_MCP_B, BTNMX_B_ROWS, BTNMX_B_COLS, SRC_MATRIX_B },
+#endif
+};
+static const uint8_t NBANKS = sizeof(BANKS) / sizeof(BANKS[0]);
+static const uint8_t ALL_BANKS = (uint8_t)((1u << NBANKS) - 1);
+static_assert(NBANKS == BTNMX_BANKS, "add the extra banks to BANKS[]");
+static_assert(BTNMX_ROWS <= 8 && BTNMX_COLS <= 8 && BTNMX_B_ROWS <= 8 && BTNMX_B_COLS <= 8,
+              "one MCP23017 port per axis");
+// A bank's scan (rows + park) must fit the queue in one go
+static_assert(BTNMX_ROWS + 1 < TWI_QUEUE_LEN && BTNMX_B_ROWS + 1 < TWI_QUEUE_LEN,
+              "TWI_QUEUE_LEN too small for a bank scan");
+
+struct BankState {
+  uint8_t rows[8];          // debounced 64-bit state word, bit c of byte r = (r, c) down
+  uint8_t raw[9];           // GPIOB per driven row, then parked
+  uint8_t intf;             // INTFB from the identify read
+};
+static BankState s_bank[NBANKS];
+
+// Per-bank bit masks
+static uint8_t s_needConfig = ALL_BANKS;   // (re)write the expander setup first
+static uint8_t s_primed = 0;               // baseline taken (keys held at boot stay quiet)
+static uint8_t s_force = ALL_BANKS;        // scan next round whatever INTFB says
+static uint8_t s_want = 0;                 // to scan this round, not queued yet
+static uint8_t s_queued = 0;               // scan jobs on the TWI
+static uint8_t s_done = 0;                 // park job finished (callback)
+static uint8_t s_failed = 0;               // a job of this round didn't complete OK
+static uint8_t s_retry = 0, s_again = 0;   // failed / moved mid-scan: scan again
+static uint8_t s_identLeft = 0;            // identify reads outstanding
+static bool s_changed = false;
+
+enum Phase : uint8_t { PH_IDLE = 0, PH_IDENT, PH_SCAN };
+static Phase s_phase = PH_IDLE;
+
+static volatile uint8_t s_irq = 1;         // INT2 fired (or baseline), round wanted
+static bool s_settling = false;            // INT2 masked until s_settleAt
+static unsigned long s_settleAt = 0;
+static int8_t s_task = -1;
+
+static inline void bankOf(uint8_t b, Bank& out) { memcpy_P(&out, &BANKS[b], sizeof(out)); }
+
+// Level-triggered: stays pending while an expander holds INT low, so a
+// change that lands while we're masked is picked up on re-arm.
+ISR(INT2_vect) {
+  EIMSK &= (uint8_t)~_BV(INT2);
+  s_irq = 1;
+  triggerLoopTask(s_task);
+}
+
+static inline void arm() {
+  EIMSK |= _BV(INT2);   // single sbi
+}
+
+static void holdOff(uint16_t ms) {
+  s_settling = true;
+  s_settleAt = millis() + ms;
+  wakeLoopTaskIn(s_task, ms);
+}
+
+static void pushKey(uint8_t src, uint8_t row, uint8_t col, bool down) {
+  Event e;
+  e.type = down ? EVT_KEY_DOWN : EVT_KEY_UP;
+  e.src  = src;
+  e.a    = row;
+  e.b    = col;
+  eb_push(e);
+}
+
+// ---- TWI callbacks (main loop); tag = bank << 4 | job ----
+static void configDone(uint8_t status, uint8_t tag) {
+  if (status != TWI_OK) s_needConfig |= (uint8_t)_BV(tag >> 4);
+}
+
+static void identDone(uint8_t status, uint8_t tag) {
+  const uint8_t b = tag >> 4;
+  if (status != TWI_OK) s_bank[b].intf = 0xFF;   // can't tell: scan it (and fail into a retry)
+  s_identLeft--;
+}
+
+static void scanJobDone(uint8_t status, uint8_t tag) {
+  const uint8_t b = tag >> 4;
+  if (status != TWI_OK) s_failed |= (uint8_t)_BV(b);
+  Bank k; bankOf(b, k);
+  if ((tag & 0x0F) == k.rows) s_done |= (uint8_t)_BV(b);   // park job is last
+}
+
+static bool configure(uint8_t b) {
+  Bank k; bankOf(b, k);
+  const uint8_t cfg[][2] = {
+    { MCP_IOCON,    IOCON_MIRROR | IOCON_ODR },
+    { MCP_IODIRA,   0x00 },                         // rows: outputs
+    { MCP_IODIRB,   0xFF },                         // columns: inputs
+    { MCP_GPPUB,    0xFF },                         // with pull-ups
+    { MCP_INTCONB,  0x00 },                         // interrupt on any change
+    { MCP_GPINTENB, (uint8_t)((1u << k.cols) - 1) },
+  };
+  const uint8_t n = sizeof(cfg) / sizeof(cfg[0]);
+  if (twi_free() < n) return false;
+  for (uint8_t i = 0; i < n; ++i) twi_writeReg(k.addr, cfg[i][0], cfg[i][1], configDone, (uint8_t)(b << 4 | i));
+  s_needConfig &= (uint8_t)~_BV(b);
+  return true;
+}
+
+// One row low at a time, read the columns; then park all rows low again.
+// Each job drives GPIOA and reads GPIOB after a repeated start (the
+// register pointer has moved on). The park read clears the interrupt the
+// scan itself raised.
+static bool submitScan(uint8_t b) {
+  Bank k; bankOf(b, k);
+  if (twi_free() < k.rows + 1) return false;
+  const uint8_t rowMask = (uint8_t)((1u << k.rows) - 1);
+  for (uint8_t r = 0; r <= k.rows; ++r) {
+    const uint8_t drive = (r < k.rows) ? (uint8_t)~_BV(r) : (uint8_t)~rowMask;
+    const uint8_t tx[2] = { MCP_GPIOA, drive };
+    twi_submit(k.addr, tx, 2, &s_bank[b].raw[r], 1, scanJobDone, (uint8_t)(b << 4 | r));
+  }
+  return true;
+}
+
+// Diff a finished scan; false if a key moved mid-scan (parked columns
+// disagree with the rows), so the bank has to be scanned again
+static bool applyScan(uint8_t b) {
+  Bank k; bankOf(b, k);
+  BankState& s = s_bank[b];
+  const uint8_t colMask = (uint8_t)((1u << k.cols) - 1);
+  const bool primed = s_primed & _BV(b);
+  uint8_t any = 0;
+  for (uint8_t r = 0; r < k.rows; ++r) {
+    const uint8_t now  = (uint8_t)~s.raw[r] & colMask;
+    const uint8_t diff = now ^ s.rows[r];
+    any |= now;
+    if (!diff) continue;
+    s_changed = true;
+    s.rows[r] = now;
+    if (!primed) continue;
+    for (uint8_t c = 0; c < k.cols; ++c) {
+      if (!(diff & _BV(c))) continue;
+      const bool down = now & _BV(c);
+      pushKey(k.src, r, c, down);
+      DL("MX "); DPRINT(b); DL(":"); DPRINT(r); DL(","); DPRINT(c); DPRINTLN(down ? " DOWN" : " UP");
     }
+  }
+  s_primed |= (uint8_t)_BV(b);
+  return (uint8_t)(~s.raw[k.rows] & colMask) == any;
+}
+
+// Start a round: ask every bank not already due a scan whether it raised
+// the interrupt. One bank needs no asking.
+static bool startRound() {
+  uint8_t ask = (NBANKS > 1) ? (uint8_t)(ALL_BANKS & ~s_force) : 0;
+  if (ask && twi_free() < NBANKS) return false;
+  s_want = (NBANKS > 1) ? s_force : ALL_BANKS;
+  s_force = 0;
+  s_changed = false;
+  s_identLeft = 0;
+  for (uint8_t b = 0; b < NBANKS; ++b) {
+    if (!(ask & _BV(b))) continue;
+    Bank k; bankOf(b, k);
+    s_bank[b].intf = 0;
+    twi_readRegs(k.addr, MCP_INTFB, &s_bank[b].intf, 1, identDone, (uint8_t)(b << 4));
+    s_identLeft++;
+  }
+  s_phase = s_identLeft ? PH_IDENT : PH_SCAN;
+  return true;
+}
+
+// Retire finished banks, queue waiting ones back to back; true when the
+// round is complete
+static bool runScans() {
+  const uint8_t done = s_done;
+  s_done = 0;
+  for (uint8_t b = 0; b < NBANKS; ++b) {
+    const uint8_t m = (uint8_t)_BV(b);
+    if (!(done & m)) continue;
+    s_queued &= (uint8_t)~m;
+    if (s_failed & m) {
+      // Expander missing or bus trouble: set it up again and retry later
+      s_failed &= (uint8_t)~m;
+      s_needConfig |= m;
+      s_retry |= m;
+    } else if (!applyScan(b)) {
+      s_again |= m;
+    }
+  }
+  for (uint8_t b = 0; b < NBANKS && s_want; ++b) {
+    const uint8_t m = (uint8_t)_BV(b);
+    if (!(s_want & m)) continue;
+    if ((s_needConfig & m) && !configure(b)) break;
+    if (!submitScan(b)) break;
+    s_want &= (uint8_t)~m;
+    s_queued |= m;
+  }
+  if (s_want) wakeLoopTaskIn(s_task, 1);   // TWI queue full; top up shortly
+  return !s_want && !s_queued;
+}
+
+static void endRound() {
+  s_phase = PH_IDLE;
+  if (s_retry) {
+    s_force |= s_retry | s_again;
+    s_retry = s_again = 0;
+    s_irq = 1;
+    holdOff(BTNMX_RETRY_MS);
+  } else if (s_again) {
+    s_force |= s_again;                  // moved mid-scan: look again now
+    s_again = 0;
+    s_irq = 1;
+    triggerLoopTask(s_task);
+  } else if (s_changed) {
+    holdOff(BTNMX_SETTLE_MS);            // let it stop bouncing first
+  } else if (!s_irq) {
+    arm();
+  }
+}
+
+void btnmx_init() {
+  pinMode(PIN_MCP_INT, INPUT_PULLUP);    // open-drain line
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    // INT2 on low level; left masked until the first round has run
+    EICRA = (uint8_t)(EICRA & ~(_BV(ISC21) | _BV(ISC20)));
+    EIMSK &= (uint8_t)~_BV(INT2);
+  }
+  // Expander setup and the baseline scan go out from the first btnmx_poll()
+}
+
+void btnmx_setTask(int8_t taskId) { s_task = taskId; }
+
+uint8_t btnmx_row(uint8_t bank, uint8_t row) {
+  return (bank < NBANKS && row < 8) ? s_bank[bank].rows[row] : 0;
+}
+
+uint64_t btnmx_state(uint8_t bank) {
+  uint64_t w = 0;
+  if (bank < NBANKS) memcpy(&w, s_bank[bank].rows, sizeof(w));   // little-endian: row 0 low
+  return w;
+}
+
+void btnmx_poll() {
+  if (s_phase == PH_IDENT) {
+    if (s_identLeft) return;             // identify reads still out; completion wakes us
+    for (uint8_t b = 0; b < NBANKS; ++b) if (s_bank[b].intf) s_want |= (uint8_t)_BV(b);
+    s_phase = PH_SCAN;
+  }
+  if (s_phase == PH_SCAN) {
+    if (runScans()) endRound();
+    return;
+  }
+
+  if (s_settling) {
+    const long left = (long)(s_settleAt - millis());
+    if (left > 0) { wakeLoopTaskIn(s_task, (uint16_t)left); return; }
+    s_settling = false;
+    // Settled: unmask; if the line is still low the ISR fires right away
+    if (!s_irq) { arm(); return; }
+  }
+
+  if (!s_irq) return;
+  if (!startRound()) { wakeLoopTaskIn(s_task, 1); return; }
+  s_irq = 0;
+  if (s_phase == PH_SCAN && runScans()) endRound();
 }
-// Clear rows
-mcp_write(0x12, 0x00);
-return bits;
-}
\ No newline at end of file
@@ -41,6 +41,13 @@ ContextObject* getContextByIndex(uint8_t index) {
   return contextPointers[index];
 }
 
+int8_t getContextIndex(const ContextObject* ctx) {
+  for (uint8_t i = 0; i < contextCount; ++i) {
+    if (contextPointers[i] == ctx) return (int8_t)i;
+  }
+  return -1;
+}
+
 void debugPrintRegisteredContextCount() {
 #if DEBUG_SERIAL
   Serial.print(F("contexts: "));
@@ -57,6 +57,9 @@ bool setContextByName(const char* nextName) {
   gCurrent = next;
   interrupts();
 
+  // Newly shown screen always needs a full frame
+  next->invalidate();
+
   // Do heavyweight work outside the critical section
 
   // No lifecycle hooks defined on ContextObject in your codebase.
@@ -84,6 +87,7 @@ bool goBack() {
     //ContextObject* old = gCurrent;
     gCurrent = prev;
     interrupts();
+    prev->invalidate();
     // No lifecycle hooks defined on ContextObject in your codebase.
   // If you add them later, you can re-enable calls here.
 
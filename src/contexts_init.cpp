@@ -8,6 +8,9 @@
 #include "menu_display.h"
 #include "menu_led.h"
 #include "menu_boot.h"
+#include "profiler.h"
+#include "event_bus.h"
+#include "latency_trace.h"
 
 extern void registerMainMenuContext();
 extern void registerSettingsMenuContext();
@@ -17,6 +20,16 @@ extern void registerSaveMenuContext();
 extern void registerDebugMenuContext();
 extern void registerSystemInfoContext();
 extern void registerTestBeepContext();
+extern void registerTasksContext();
+#if EB_STATS
+extern void registerEventsContext();
+#endif
+#if PROF_ENABLED
+extern void registerProfilerContext();
+#endif
+#if LAT_TRACE
+extern void registerLatencyContext();
+#endif
 extern void registerDisplayOptionsContext();
 extern void registerDisplayBrightnessContext();
 extern void registerDisplayInvertContext();
@@ -40,6 +53,16 @@ void registerAllContexts() {
   // Debug sub-screens
   registerSystemInfoContext();
   registerTestBeepContext();
+  registerTasksContext();
+#if EB_STATS
+  registerEventsContext();
+#endif
+#if PROF_ENABLED
+  registerProfilerContext();
+#endif
+#if LAT_TRACE
+  registerLatencyContext();
+#endif
 
   // Display settings and subs
   registerDisplayOptionsContext();
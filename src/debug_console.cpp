@@ -0,0 +1,51 @@
+// debug_console.cpp
+#include <Arduino.h>
+#include "debug_console.h"
+#include "debug.h"
+#include "profiler.h"
+#include "LoopManager.h"
+#include "display_st7920.h"
+#include "event_bus.h"
+#include "latency_trace.h"
+#include "sequencer_core.h"
+#include "ram_stats.h"
+
+#if DEBUG_SERIAL
+
+static void printHelp() {
+  DLLN("cmds: ? help | p profile | P reset profile | t tasks | T reset tasks");
+  DLLN("      d display stats | D display bench | r reset display stats");
+  DLLN("      e event stats | E reset event stats | l latency | L reset latency");
+  DLLN("      s sequencer step cost | S reset sequencer stats | b sequencer bench");
+  DLLN("      m RAM static/free/min free");
+}
+
+void console_poll() {
+  if (!Serial.available()) return;
+  const int c = Serial.read();
+  switch (c) {
+    case '?': printHelp();   break;
+    case 'p': prof_dump();   break;
+    case 'P': prof_reset(); DLLN("profile reset"); break;
+    case 't': dumpLoopTasks(); break;
+    case 'T': resetLoopTaskStats(); DLLN("task stats reset"); break;
+    case 'd': disp_dumpStats(); break;
+    case 'D': disp_benchmark(); break;
+    case 'r': disp_resetStats(); DLLN("display stats reset"); break;
+    case 'e': eb_statsDump(); break;
+    case 'E': eb_statsReset(); DLLN("event stats reset"); break;
+    case 'l': lat_dump(); break;
+    case 'L': lat_reset(); DLLN("latency reset"); break;
+    case 's': seq_statsDump(); break;
+    case 'S': seq_statsReset(); DLLN("sequencer stats reset"); break;
+    case 'b': seq_benchmark(); break;
+    case 'm': ram_dump(); break;
+    default:  break;         // ignore CR/LF and unknown keys
+  }
+}
+
+#else
+
+void console_poll() {}
+
+#endif // DEBUG_SERIAL
@@ -0,0 +1,437 @@
+// display_st7920.cpp
+#include <Arduino.h>
+#include <avr/io.h>
+#include "display_st7920.h"
+#include "object_classes.h"
+#include "context_registry.h"
+#include "render_gate.h"
+#include "timebase.h"
+#include "debug.h"
+
+#define DISP_CHUNK_BYTES  (DISP_ROW_BYTES / 2)        // half a pixel row
+#define DISP_CHUNK_COUNT  (DISP_HEIGHT * 2)
+
+static U8G2*       s_gfx = nullptr;
+static u8x8_msg_cb s_driver = nullptr;   // U8g2's own ST7920 display callback
+static uint32_t    s_bytes = 0;
+static uint32_t    s_frames = 0;
+
+#if DISP_ROW_DIFF
+static uint8_t s_shadow[DISP_HEIGHT * DISP_ROW_BYTES];   // what the ST7920 shows
+static bool    s_shadowValid = false;
+static bool    s_resync = false;     // current pass started from an invalid shadow
+#endif
+
+#if DISP_ASYNC_FLUSH
+static const uint8_t* s_frame = nullptr;   // U8g2 frame buffer being flushed
+static bool           s_pending = false;
+static uint8_t        s_chunk = 0;         // next half-row to look at
+#endif
+
+// ---- Byte transports ----
+
+#define LCD_NOP() __asm__ __volatile__("nop")
+
+#if DISP_TRANSPORT != DISP_TRANSPORT_U8G2
+// Catch a board profile that doesn't match config_pins.h
+static void checkPin(uint8_t pin, uint8_t bit) {
+  if (portOutputRegister(digitalPinToPort(pin)) != &LCD_PORT ||
+      digitalPinToBitMask(pin) != _BV(bit)) {
+    DL("display: pin "); DPRINT(pin); DLLN(" doesn't match board_profile port bit");
+  }
+}
+
+static inline void lcdSelect(u8x8_t* u8x8, uint8_t level, uint8_t bit) {
+  if (level) LCD_PORT |= _BV(bit); else LCD_PORT &= ~_BV(bit);
+  (void)u8x8;
+}
+#endif
+
+#if DISP_TRANSPORT == DISP_TRANSPORT_PORT
+// SPI mode 3, MSB first: data changes while SCK is low, sampled on the
+// rising edge. PORTB is in I/O space, so each line change is one sbi/cbi.
+#define LCD_SEND_BIT(b, m) do {                                               \
+    LCD_PORT &= ~_BV(LCD_CLK_BIT);                                            \
+    if ((b) & (m)) LCD_PORT |= _BV(LCD_MOSI_BIT); else LCD_PORT &= ~_BV(LCD_MOSI_BIT); \
+    for (uint8_t _n = 0; _n < LCD_SPI_NOPS; ++_n) LCD_NOP();                  \
+    LCD_PORT |= _BV(LCD_CLK_BIT);                                             \
+    for (uint8_t _n = 0; _n < LCD_SPI_NOPS; ++_n) LCD_NOP();                  \
+  } while (0)
+
+static uint8_t byteCb(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  switch (msg) {
+    case U8X8_MSG_BYTE_SEND: {
+      const uint8_t* p = (const uint8_t*)arg_ptr;
+      while (arg_int--) {
+        const uint8_t b = *p++;
+        LCD_SEND_BIT(b, 0x80); LCD_SEND_BIT(b, 0x40);
+        LCD_SEND_BIT(b, 0x20); LCD_SEND_BIT(b, 0x10);
+        LCD_SEND_BIT(b, 0x08); LCD_SEND_BIT(b, 0x04);
+        LCD_SEND_BIT(b, 0x02); LCD_SEND_BIT(b, 0x01);
+      }
+      break;
+    }
+    case U8X8_MSG_BYTE_INIT:
+      checkPin(LCD_CLK, LCD_CLK_BIT);
+      checkPin(LCD_MOSI, LCD_MOSI_BIT);
+      checkPin(LCD_CS, LCD_CS_BIT);
+      LCD_DDR  |= _BV(LCD_CLK_BIT) | _BV(LCD_MOSI_BIT) | _BV(LCD_CS_BIT);
+      LCD_PORT |= _BV(LCD_CLK_BIT);   // idle high (mode 3)
+      lcdSelect(u8x8, u8x8->display_info->chip_disable_level, LCD_CS_BIT);
+      break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      lcdSelect(u8x8, u8x8->display_info->chip_enable_level, LCD_CS_BIT);
+      break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      lcdSelect(u8x8, u8x8->display_info->chip_disable_level, LCD_CS_BIT);
+      break;
+    case U8X8_MSG_BYTE_SET_DC:   // ST7920 serial has no D/C line
+    default:
+      break;
+  }
+  return 1;
+}
+
+#elif DISP_TRANSPORT == DISP_TRANSPORT_HWSPI
+// SPI peripheral, mode 3 at F_CPU/8 (2 MHz, inside the ST7920's ~2.5 MHz).
+// The control registers are reloaded per transfer because SD shares the bus.
+static inline void spiSetup() {
+  SPCR = _BV(SPE) | _BV(MSTR) | _BV(CPOL) | _BV(CPHA) | _BV(SPR0);
+  SPSR |= _BV(SPI2X);
+}
+
+static uint8_t byteCb(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  switch (msg) {
+    case U8X8_MSG_BYTE_SEND: {
+      const uint8_t* p = (const uint8_t*)arg_ptr;
+      while (arg_int--) {
+        SPDR = *p++;
+        while (!(SPSR & _BV(SPIF))) {}
+      }
+      break;
+    }
+    case U8X8_MSG_BYTE_INIT:
+      checkPin(PIN_SPI_SCK, LCD_HW_SCK_BIT);
+      checkPin(PIN_SPI_MOSI, LCD_HW_MOSI_BIT);
+      checkPin(LCD_HW_CS, LCD_HW_CS_BIT);
+      // CS on SS (53) keeps the SPI in master mode while it's an output
+      LCD_DDR |= _BV(LCD_HW_SCK_BIT) | _BV(LCD_HW_MOSI_BIT) | _BV(LCD_HW_CS_BIT);
+      lcdSelect(u8x8, u8x8->display_info->chip_disable_level, LCD_HW_CS_BIT);
+      spiSetup();
+      break;
+    case U8X8_MSG_BYTE_START_TRANSFER:
+      spiSetup();
+      lcdSelect(u8x8, u8x8->display_info->chip_enable_level, LCD_HW_CS_BIT);
+      break;
+    case U8X8_MSG_BYTE_END_TRANSFER:
+      lcdSelect(u8x8, u8x8->display_info->chip_disable_level, LCD_HW_CS_BIT);
+      break;
+    case U8X8_MSG_BYTE_SET_DC:
+    default:
+      break;
+  }
+  return 1;
+}
+#endif // DISP_TRANSPORT
+
+#if DISP_TRANSPORT != DISP_TRANSPORT_U8G2
+U8G2_ST7920_128X64_FAST::U8G2_ST7920_128X64_FAST(const u8g2_cb_t* rotation) : U8G2() {
+  // Stock GPIO/delay callback: no pins registered, it only provides delays
+#if DISP_FULL_BUFFER
+  u8g2_Setup_st7920_s_128x64_f(&u8g2, rotation, byteCb, u8x8_gpio_and_delay_arduino);
+#else
+  u8g2_Setup_st7920_s_128x64_1(&u8g2, rotation, byteCb, u8x8_gpio_and_delay_arduino);
+#endif
+}
+#endif
+
+// ---- Row diff ----
+
+// Word span [w0, w1] of one half-row chunk that must go out; false if the
+// controller already shows it. Updates the shadow for what will be sent.
+static bool chunkSpan(const uint8_t* line, uint8_t row, uint8_t half,
+                      uint8_t& w0, uint8_t& w1) {
+  uint8_t first = half * DISP_CHUNK_BYTES;
+  uint8_t last  = first + DISP_CHUNK_BYTES - 1;
+#if DISP_ROW_DIFF
+  uint8_t* shadow = &s_shadow[row * DISP_ROW_BYTES];
+  if (s_shadowValid) {
+    const uint8_t end = last + 1;
+    while (first < end && line[first] == shadow[first]) first++;
+    if (first == end) return false;
+    while (line[last] == shadow[last]) last--;
+  }
+  memcpy(&shadow[first], &line[first], last - first + 1);
+#else
+  (void)row;
+#endif
+  w0 = first / 2;
+  w1 = last / 2;
+  return true;
+}
+
+static inline void beginTransfer(u8x8_t* u8x8) {
+  u8x8_cad_StartTransfer(u8x8);
+  u8x8_cad_SendCmd(u8x8, 0x3E);   // extended instruction set, graphics on
+  s_bytes++;
+}
+
+// ST7920 GDRAM: 32 rows of 256 px. Screen rows 32..63 live in the right
+// half of rows 0..31, i.e. word column + 8. Address bytes carry bit 7.
+static inline void sendRowSpan(u8x8_t* u8x8, uint8_t row, uint8_t w0, uint8_t w1,
+                               const uint8_t* line) {
+  uint8_t y = row, x = w0;
+  if (y >= DISP_HEIGHT / 2) { y -= DISP_HEIGHT / 2; x += 8; }
+  const uint8_t n = (uint8_t)((w1 - w0 + 1) * 2);
+  u8x8_cad_SendCmd(u8x8, 0x80 | y);
+  u8x8_cad_SendCmd(u8x8, 0x80 | x);
+  u8x8_cad_SendData(u8x8, n, line + w0 * 2);
+  s_bytes += 2 + n;
+}
+
+// Send the changed parts of 8 pixel rows right away (page buffer mode)
+static void sendTileRow(u8x8_t* u8x8, uint8_t row0, const uint8_t* src) {
+  bool open = false;
+  for (uint8_t i = 0; i < 8; ++i, src += DISP_ROW_BYTES) {
+    for (uint8_t half = 0; half < 2; ++half) {
+      uint8_t w0, w1;
+      if (!chunkSpan(src, row0 + i, half, w0, w1)) continue;
+      if (!open) { beginTransfer(u8x8); open = true; }
+      sendRowSpan(u8x8, row0 + i, w0, w1, src);
+    }
+  }
+  if (open) u8x8_cad_EndTransfer(u8x8);
+}
+
+// Replaces DRAW_TILE for full-width tile rows (what sendBuffer/nextPage
+// emit); anything else goes to the stock driver untouched.
+static uint8_t displayHook(u8x8_t* u8x8, uint8_t msg, uint8_t arg_int, void* arg_ptr) {
+  if (msg != U8X8_MSG_DISPLAY_DRAW_TILE) return s_driver(u8x8, msg, arg_int, arg_ptr);
+
+  const u8x8_tile_t* t = (const u8x8_tile_t*)arg_ptr;
+  if (t->x_pos != 0 || t->cnt != DISP_ROW_BYTES) {
+#if DISP_ROW_DIFF
+    s_shadowValid = false;   // partial tile write (u8x8 API); resync next frame
+#endif
+    return s_driver(u8x8, msg, arg_int, arg_ptr);
+  }
+  if (t->y_pos == (DISP_HEIGHT / 8) - 1) s_frames++;
+
+#if DISP_ASYNC_FLUSH
+  // Full buffer: just note the frame; disp_pump() sends it in chunks.
+  if (t->y_pos == 0) s_frame = t->tile_ptr;
+  if (t->y_pos == (DISP_HEIGHT / 8) - 1) {
+  #if DISP_ROW_DIFF
+    s_resync = !s_shadowValid;
+  #endif
+    s_chunk = 0;
+    s_pending = true;
+  }
+#else
+  #if DISP_ROW_DIFF
+  if (t->y_pos == 0) s_resync = !s_shadowValid;
+  #endif
+  sendTileRow(u8x8, (uint8_t)(t->y_pos * 8), t->tile_ptr);
+  #if DISP_ROW_DIFF
+  // A full pass sent from row 0 leaves the shadow in sync again
+  if (s_resync && t->y_pos == (DISP_HEIGHT / 8) - 1) s_shadowValid = true;
+  #endif
+#endif
+  return 1;
+}
+
+void disp_attach(U8G2* g) {
+  s_gfx = g;
+  u8x8_t* u8x8 = g->getU8x8();
+  if (!s_driver) s_driver = u8x8->display_cb;
+  u8x8->display_cb = displayHook;
+  disp_invalidate();
+}
+
+void disp_invalidate() {
+#if DISP_ROW_DIFF
+  s_shadowValid = false;
+  s_resync = false;
+#endif
+}
+
+uint32_t disp_bytesSent()  { return s_bytes; }
+uint32_t disp_frameCount() { return s_frames; }
+
+#if DISP_BENCH && DISP_ASYNC_FLUSH
+static void frameFlushed(uint32_t flushTb);
+#endif
+
+#if DISP_ASYNC_FLUSH
+
+bool disp_busy() { return s_pending; }
+
+bool disp_pump(uint16_t budgetUs) {
+  if (!s_pending || !s_gfx) return false;
+  u8x8_t* u8x8 = s_gfx->getU8x8();
+  const uint32_t t0 = tb_now();
+  const uint32_t limit = tb_from_us(budgetUs);
+  bool open = false;
+
+  // At least one chunk per call so a tiny budget still makes progress
+  do {
+    uint8_t w0, w1;
+    const uint8_t row  = s_chunk >> 1;
+    const uint8_t half = s_chunk & 1;
+    const uint8_t* line = s_frame + row * DISP_ROW_BYTES;
+    const bool send = chunkSpan(line, row, half, w0, w1);
+    if (send) {
+      if (!open) { beginTransfer(u8x8); open = true; }
+      sendRowSpan(u8x8, row, w0, w1, line);
+    }
+    if (++s_chunk >= DISP_CHUNK_COUNT) {
+#if DISP_ROW_DIFF
+      if (s_resync) s_shadowValid = true;
+#endif
+      s_pending = false;
+      break;
+    }
+  } while ((tb_now() - t0) < limit);
+
+  if (open) u8x8_cad_EndTransfer(u8x8);
+#if DISP_BENCH
+  frameFlushed(tb_now() - t0);
+#endif
+  return s_pending;
+}
+
+void disp_flush() {
+  while (disp_pump(0xFFFF)) {}
+}
+
+#endif // DISP_ASYNC_FLUSH
+
+#if DISP_BENCH
+
+struct DispStat {
+  uint16_t frames;
+  uint16_t maxUs;
+  uint32_t sumUs;
+  uint32_t sumBytes;
+};
+
+static DispStat s_ctx[DISP_STAT_SLOTS];
+static uint8_t  s_ctxOf[DISP_STAT_SLOTS];   // registry index + 1, 0 = free
+static uint32_t s_t0, s_bytes0;
+#if DISP_ASYNC_FLUSH
+static uint32_t s_frameTb;         // draw + transfer time of the frame in flight
+#endif
+static int8_t   s_frameCtx = -1;   // registry index the frame belongs to
+
+// Row of a registry index, claiming a free one; -1 once all are taken
+static int8_t statSlot(int8_t registryIndex) {
+  if (registryIndex < 0) return -1;
+  for (uint8_t i = 0; i < DISP_STAT_SLOTS; ++i) {
+    if (!s_ctxOf[i]) s_ctxOf[i] = (uint8_t)(registryIndex + 1);
+    if (s_ctxOf[i] == registryIndex + 1) return (int8_t)i;
+  }
+  return -1;
+}
+
+static void statAdd(int8_t ctxIndex, uint32_t us, uint32_t bytes) {
+  const int8_t i = statSlot(ctxIndex);
+  if (i < 0) return;
+  DispStat& s = s_ctx[i];
+  if (s.frames == 0xFFFF) return;   // saturated until disp_resetStats()
+  s.frames++;
+  s.sumUs    += us;
+  s.sumBytes += bytes;
+  if (us > s.maxUs) s.maxUs = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+}
+
+void disp_frameBegin() {
+  s_bytes0 = s_bytes;
+  s_t0 = tb_now();
+}
+
+void disp_frameEnd(const ContextObject* ctx) {
+  const uint32_t tb = tb_now() - s_t0;
+#if DISP_ASYNC_FLUSH
+  // Bytes go out later; the stats land when the last chunk does
+  s_frameTb  = tb;
+  s_frameCtx = getContextIndex(ctx);
+#else
+  statAdd(getContextIndex(ctx), tb_to_us(tb), s_bytes - s_bytes0);
+#endif
+}
+
+#if DISP_ASYNC_FLUSH
+static void frameFlushed(uint32_t flushTb) {
+  s_frameTb += flushTb;
+  if (disp_busy() || s_frameCtx < 0) return;
+  statAdd(s_frameCtx, tb_to_us(s_frameTb), s_bytes - s_bytes0);
+  s_frameCtx = -1;
+}
+#endif
+
+void disp_resetStats() {
+  memset(s_ctx,   0, sizeof(s_ctx));
+  memset(s_ctxOf, 0, sizeof(s_ctxOf));
+}
+
+void disp_dumpStats() {
+  DLLN("-- display --  name frames avgB avgUs maxUs");
+  for (uint8_t i = 0; i < DISP_STAT_SLOTS && s_ctxOf[i]; ++i) {
+    const DispStat& s = s_ctx[i];
+    if (!s.frames) continue;
+    ContextObject* ctx = getContextByIndex((uint8_t)(s_ctxOf[i] - 1));
+    char line[48];
+    snprintf_P(line, sizeof(line), PSTR("%-14.14s%6u%6lu%7lu%7u"), ctx ? ctx->name : "?",
+             (unsigned)s.frames, (unsigned long)(s.sumBytes / s.frames),
+             (unsigned long)(s.sumUs / s.frames), (unsigned)s.maxUs);
+    DPRINTLN(line);
+  }
+}
+
+// One measured draw of ctx (transfer included): bytes sent and microseconds
+static void benchDraw(ContextObject* ctx, uint32_t& bytes, uint32_t& us) {
+  const uint32_t b0 = s_bytes;
+  const uint32_t t0 = tb_now();
+  ctx->draw(s_gfx);
+  disp_flush();
+  us = tb_to_us(tb_now() - t0);
+  bytes = s_bytes - b0;
+}
+
+void disp_benchmark() {
+  if (!s_gfx) return;
+  disp_flush();        // finish the frame in flight first
+  s_frameCtx = -1;     // and keep the bench out of the live stats
+#if DISP_FULL_BUFFER
+  DL("-- display bench (full buffer");
+#else
+  DL("-- display bench (page buffer");
+#endif
+#if DISP_TRANSPORT == DISP_TRANSPORT_PORT
+  DL(", port SPI");
+#elif DISP_TRANSPORT == DISP_TRANSPORT_HWSPI
+  DL(", HW SPI");
+#else
+  DL(", U8g2 SPI");
+#endif
+#if DISP_ROW_DIFF
+  DL(", row diff");
+#endif
+  DLLN(") --  name fullB fullUs diffB diffUs");
+  for (uint8_t i = 0; i < getRegisteredContextCount(); ++i) {
+    ContextObject* ctx = getContextByIndex(i);
+    if (!ctx) continue;
+    uint32_t fb, fu, db, du;
+    disp_invalidate();
+    benchDraw(ctx, fb, fu);   // everything goes out
+    benchDraw(ctx, db, du);   // same frame again: only the diff
+    char line[48];
+    snprintf_P(line, sizeof(line), PSTR("%-14.14s%6lu%7lu%6lu%7lu"), ctx->name,
+             (unsigned long)fb, (unsigned long)fu, (unsigned long)db, (unsigned long)du);
+    DPRINTLN(line);
+  }
+  // The screen now shows the last benchmarked context; repaint ours
+  render_invalidate();
+}
+
+#endif // DISP_BENCH
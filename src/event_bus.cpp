@@ -1,33 +1,319 @@
 // event_bus.cpp
 #include "event_bus.h"
 #include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
+#include "config.h"
+#include "timebase.h"
+#include "debug.h"
 
-static const uint8_t Q_LEN = 32;            // must be power of two
-static volatile uint8_t headIdx = 0;
-static volatile uint8_t tailIdx = 0;
-static Event q[Q_LEN];
+// Keeps the compiler from moving slot accesses across an index update.
+// AVR has no reordering of its own, and 8-bit loads/stores are atomic.
+#define EB_BARRIER() __asm__ __volatile__("" ::: "memory")
 
-static inline uint8_t advance(uint8_t i){ return (uint8_t)((i + 1) & (Q_LEN - 1)); }
+static_assert((EVENT_QUEUE_LEN & (EVENT_QUEUE_LEN - 1)) == 0, "EVENT_QUEUE_LEN must be a power of two");
+static_assert((EB_RING_LEN_ISR & (EB_RING_LEN_ISR - 1)) == 0, "EB_RING_LEN_ISR must be a power of two");
 
-bool eb_pushFromISR(const Event& e){
-  uint8_t n = advance(headIdx);
-  if (n == tailIdx) return false;           // full
-  q[headIdx] = e;                            // write element
-  headIdx = n;                               // publish
+struct Slot {
+  Event    e;
+  uint32_t ts;                 // tb_now() at push
+};
+
+// One SPSC ring per producer: head written only by the producer, tail only
+// by the consumer (route_events in the main loop).
+struct Ring {
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  uint8_t mask;
+  Slot* q;
+};
+
+static Slot qMain[EVENT_QUEUE_LEN];
+static Slot qClock[EB_RING_LEN_ISR];
+static Slot qExt[EB_RING_LEN_ISR];
+static Ring rings[PROD_COUNT] = {
+  { 0, 0, EVENT_QUEUE_LEN - 1, qMain  },
+  { 0, 0, EB_RING_LEN_ISR - 1, qClock },
+  { 0, 0, EB_RING_LEN_ISR - 1, qExt   },
+  { 0, 0, 0,                   nullptr },   // ADC: coalesced controls only, ring always "full"
+};
+
+// Control lane: latest event per control index. The producer writes the
+// slot, then its flag, then ctrlAny; the consumer clears in the reverse
+// order, so a value written mid-read is picked up on the next pass.
+// type/src are fixed per index and b is one byte, so a slot can't tear.
+static Event ctrl[EB_CONTROL_SLOTS];
+static volatile uint8_t ctrlFlag[EB_CONTROL_SLOTS];
+static volatile uint8_t ctrlAny = 0;
+static uint8_t ctrlNext = 0;   // round-robin start so low indices can't starve high ones
+#if EB_CTRL_STAMPS
+static uint16_t ctrlTs[EB_CONTROL_SLOTS];   // tb >> CTRL_TS_SHIFT at push
+#define CTRL_TS_SHIFT 4
+#endif
+
+#if EB_STATS
+// Producer-side counters live per producer so each has a single writer
+struct ProdStats {
+  uint8_t  hwm;                  // highest ring fill seen after a push
+  uint16_t drops;
+  uint16_t coalesced;            // control values overwritten undelivered
+  uint16_t dropSrc[SRC_COUNT];
+  uint16_t dropType[EVT_TYPE_COUNT];
+};
+static ProdStats prodStats[PROD_COUNT];
+
+// Consumer-side counters (main loop only)
+static uint32_t totalSrc[SRC_COUNT],  totalType[EVT_TYPE_COUNT];
+static uint16_t winSrc[SRC_COUNT],    winType[EVT_TYPE_COUNT];   // current second
+static uint16_t rateSrc[SRC_COUNT],   rateType[EVT_TYPE_COUNT];  // last full second
+static unsigned long winStart = 0;
+
+static inline void sat16(uint16_t& c) { if (c != 0xFFFF) c++; }
+
+static void countDrop(uint8_t producer, const Event& e) {
+  ProdStats& s = prodStats[producer < PROD_COUNT ? producer : (uint8_t)PROD_MAIN];
+  sat16(s.drops);
+  if (e.src  < SRC_COUNT)      sat16(s.dropSrc[e.src]);
+  if (e.type < EVT_TYPE_COUNT) sat16(s.dropType[e.type]);
+}
+
+static void countDelivered(const Event& e) {
+  if (e.src < SRC_COUNT)       { totalSrc[e.src]++;   sat16(winSrc[e.src]); }
+  if (e.type < EVT_TYPE_COUNT) { totalType[e.type]++; sat16(winType[e.type]); }
+}
+#else
+static inline void countDrop(uint8_t, const Event&) {}
+static inline void countDelivered(const Event&) {}
+#endif
+
+EventLane eb_laneOf(uint8_t type) {
+  switch (type) {
+    case EVT_TICK_1MS:
+    case EVT_TICK_24PPQN:
+    case EVT_CLOCK_SYNC: return LANE_CLOCK;
+    case EVT_POT_MOVE:   return LANE_CONTROL;
+    default:             return LANE_KEYS;
+  }
+}
+
+bool eb_pushFrom(uint8_t producer, const Event& e) {
+  if (eb_laneOf(e.type) == LANE_CONTROL) {
+    if (e.a >= EB_CONTROL_SLOTS) { countDrop(producer, e); return false; }
+#if EB_STATS
+    if (ctrlFlag[e.a] && producer < PROD_COUNT) sat16(prodStats[producer].coalesced);
+#endif
+    ctrl[e.a] = e;                 // overwrite any undelivered value
+#if EB_CTRL_STAMPS
+    ctrlTs[e.a] = (uint16_t)(((producer == PROD_MAIN) ? tb_now() : tb_nowISR()) >> CTRL_TS_SHIFT);
+#endif
+    EB_BARRIER();
+    ctrlFlag[e.a] = 1;
+    ctrlAny = 1;
+    return true;
+  }
+  if (producer >= PROD_COUNT) return false;
+  Ring& r = rings[producer];
+  const uint8_t h = r.head;
+  const uint8_t n = (uint8_t)((h + 1) & r.mask);
+  const uint8_t t = r.tail;
+  if (n == t) { countDrop(producer, e); return false; }   // full
+  r.q[h].e  = e;                   // write element
+  r.q[h].ts = (producer == PROD_MAIN) ? tb_now() : tb_nowISR();
+  EB_BARRIER();
+  r.head = n;                      // publish
+#if EB_STATS
+  const uint8_t used = (uint8_t)((n - t) & r.mask);
+  if (used > prodStats[producer].hwm) prodStats[producer].hwm = used;
+#endif
   return true;
 }
 
-bool eb_push(const Event& e){
-  // main-loop producer: prevent race with ISR producer
-  noInterrupts();
-  bool ok = eb_pushFromISR(e);
-  interrupts();
-  return ok;
+static bool ctrlPop(Event& e, uint32_t& pushedAt) {
+  if (!ctrlAny) return false;
+  ctrlAny = 0;
+  EB_BARRIER();
+  for (uint8_t k = 0; k < EB_CONTROL_SLOTS; ++k) {
+    const uint8_t i = (uint8_t)((ctrlNext + k) % EB_CONTROL_SLOTS);
+    if (!ctrlFlag[i]) continue;
+    ctrlFlag[i] = 0;
+    EB_BARRIER();
+    e = ctrl[i];
+#if EB_CTRL_STAMPS
+    // Widen the 16-bit stamp against now (valid for ages up to ~0.5 s)
+    const uint32_t now = tb_now();
+    const uint16_t age = (uint16_t)((uint16_t)(now >> CTRL_TS_SHIFT) - ctrlTs[i]);
+    pushedAt = now - ((uint32_t)age << CTRL_TS_SHIFT);
+#else
+    pushedAt = tb_now();
+#endif
+    ctrlNext = (uint8_t)((i + 1) % EB_CONTROL_SLOTS);
+    ctrlAny = 1;                   // others may still be pending; rescan next pop
+    countDelivered(e);
+    return true;
+  }
+  return false;
+}
+
+bool eb_pop(Event& e) {
+  uint32_t ts;
+  return eb_popStamped(e, ts);
 }
 
-bool eb_pop(Event& e){
-  if (tailIdx == headIdx) return false;     // empty
-  e = q[tailIdx];
-  tailIdx = advance(tailIdx);
+bool eb_popStamped(Event& e, uint32_t& pushedAt) {
+  // Merge the ring heads: most urgent lane first, then the oldest stamp
+  int8_t best = -1;
+  uint8_t bestLane = LANE_COUNT;
+  uint32_t bestTs = 0;
+  const uint32_t now = tb_now();
+  for (uint8_t p = 0; p < PROD_COUNT; ++p) {
+    const Ring& r = rings[p];
+    const uint8_t t = r.tail;
+    if (t == r.head) continue;     // empty
+    EB_BARRIER();
+    const Slot& s = r.q[t];
+    const uint8_t lane = eb_laneOf(s.e.type);
+    const uint32_t age = now - s.ts;
+    if (lane < bestLane || (lane == bestLane && age > now - bestTs)) {
+      best = (int8_t)p; bestLane = lane; bestTs = s.ts;
+    }
+  }
+  if (best < 0) return ctrlPop(e, pushedAt);
+
+  Ring& r = rings[best];
+  const uint8_t t = r.tail;
+  e = r.q[t].e;
+  pushedAt = r.q[t].ts;
+  EB_BARRIER();
+  r.tail = (uint8_t)((t + 1) & r.mask);   // hand the slot back
+  countDelivered(e);
   return true;
 }
+
+#if EB_STATS
+
+static const char P_MAIN[] PROGMEM = "main";
+static const char P_CLK[]  PROGMEM = "clkISR";
+static const char P_EXT[]  PROGMEM = "extISR";
+static const char P_ADC[]  PROGMEM = "adcISR";
+static const char* const PROD_NAMES[PROD_COUNT] PROGMEM = { P_MAIN, P_CLK, P_EXT, P_ADC };
+
+static const char S_NONE[]  PROGMEM = "none";
+static const char S_FN[]    PROGMEM = "fnkeys";
+static const char S_MATA[]  PROGMEM = "matrixA";
+static const char S_MATB[]  PROGMEM = "matrixB";
+static const char S_POTS[]  PROGMEM = "pots";
+static const char S_CLOCK[] PROGMEM = "clock";
+static const char S_I2C[]   PROGMEM = "i2c";
+static const char* const SRC_NAMES[SRC_COUNT] PROGMEM = {
+  S_NONE, S_FN, S_MATA, S_MATB, S_POTS, S_CLOCK, S_I2C
+};
+
+static const char T_NONE[] PROGMEM = "none";
+static const char T_KDN[]  PROGMEM = "keydown";
+static const char T_KUP[]  PROGMEM = "keyup";
+static const char T_POT[]  PROGMEM = "potmove";
+static const char T_1MS[]  PROGMEM = "tick1ms";
+static const char T_24[]   PROGMEM = "tick24";
+static const char T_SYNC[] PROGMEM = "sync";
+static const char T_BERR[] PROGMEM = "buserr";
+static const char* const TYPE_NAMES[EVT_TYPE_COUNT] PROGMEM = {
+  T_NONE, T_KDN, T_KUP, T_POT, T_1MS, T_24, T_SYNC, T_BERR
+};
+
+const char* eb_producerName(uint8_t p) { return p < PROD_COUNT ? (const char*)pgm_read_ptr(&PROD_NAMES[p]) : S_NONE; }
+const char* eb_sourceName(uint8_t s)   { return s < SRC_COUNT ? (const char*)pgm_read_ptr(&SRC_NAMES[s]) : S_NONE; }
+const char* eb_typeName(uint8_t t)     { return t < EVT_TYPE_COUNT ? (const char*)pgm_read_ptr(&TYPE_NAMES[t]) : T_NONE; }
+
+void eb_statsPoll() {
+  const unsigned long now = millis();
+  if ((now - winStart) < 1000) return;
+  winStart = now;
+  memcpy(rateSrc, winSrc, sizeof(rateSrc));
+  memcpy(rateType, winType, sizeof(rateType));
+  memset(winSrc, 0, sizeof(winSrc));
+  memset(winType, 0, sizeof(winType));
+}
+
+void eb_statsReset() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { memset(prodStats, 0, sizeof(prodStats)); }
+  memset(totalSrc, 0, sizeof(totalSrc));
+  memset(totalType, 0, sizeof(totalType));
+  memset(winSrc, 0, sizeof(winSrc));
+  memset(winType, 0, sizeof(winType));
+  memset(rateSrc, 0, sizeof(rateSrc));
+  memset(rateType, 0, sizeof(rateType));
+}
+
+// Drops for one source or type summed over all producers (ISR-written,
+// so read atomically)
+static uint16_t sumDrops(bool bySource, uint8_t i) {
+  uint32_t sum = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t p = 0; p < PROD_COUNT; ++p)
+      sum += bySource ? prodStats[p].dropSrc[i] : prodStats[p].dropType[i];
+  }
+  return sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+}
+
+void eb_statsBySource(uint8_t src, EbStat& out) {
+  if (src >= SRC_COUNT) { memset(&out, 0, sizeof(out)); return; }
+  out.total  = totalSrc[src];
+  out.perSec = rateSrc[src];
+  out.drops  = sumDrops(true, src);
+}
+
+void eb_statsByType(uint8_t type, EbStat& out) {
+  if (type >= EVT_TYPE_COUNT) { memset(&out, 0, sizeof(out)); return; }
+  out.total  = totalType[type];
+  out.perSec = rateType[type];
+  out.drops  = sumDrops(false, type);
+}
+
+uint8_t eb_ringLen(uint8_t p)  { return p < PROD_COUNT ? rings[p].mask : 0; }   // usable slots
+uint8_t eb_ringUsed(uint8_t p) { return p < PROD_COUNT ? (uint8_t)((rings[p].head - rings[p].tail) & rings[p].mask) : 0; }
+uint8_t eb_ringHighWater(uint8_t p) { return p < PROD_COUNT ? prodStats[p].hwm : 0; }
+
+uint16_t eb_ringDrops(uint8_t p) {
+  if (p >= PROD_COUNT) return 0;
+  uint16_t d;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { d = prodStats[p].drops; }
+  return d;
+}
+
+uint16_t eb_ctrlCoalesced() {
+  uint32_t sum = 0;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    for (uint8_t p = 0; p < PROD_COUNT; ++p) sum += prodStats[p].coalesced;
+  }
+  return sum > 0xFFFF ? 0xFFFF : (uint16_t)sum;
+}
+
+void eb_statsDump() {
+  char name[10], line[48];
+  DLLN("-- event rings --  prod used/len hwm drops");
+  for (uint8_t p = 0; p < PROD_COUNT; ++p) {
+    strncpy_P(name, eb_producerName(p), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    snprintf_P(line, sizeof(line), PSTR("%-8s%4u/%-3u%4u%6u"), name, (unsigned)eb_ringUsed(p),
+             (unsigned)eb_ringLen(p), (unsigned)eb_ringHighWater(p), (unsigned)eb_ringDrops(p));
+    DPRINTLN(line);
+  }
+  DL("controls coalesced: "); DPRINTLN(eb_ctrlCoalesced());
+  DLLN("-- by source --  name total /s drops");
+  for (uint8_t s = 0; s < SRC_COUNT; ++s) {
+    EbStat st; eb_statsBySource(s, st);
+    strncpy_P(name, eb_sourceName(s), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    snprintf_P(line, sizeof(line), PSTR("%-8s%10lu%6u%6u"), name, (unsigned long)st.total,
+             (unsigned)st.perSec, (unsigned)st.drops);
+    DPRINTLN(line);
+  }
+  DLLN("-- by type --  name total /s drops");
+  for (uint8_t t = 0; t < EVT_TYPE_COUNT; ++t) {
+    EbStat st; eb_statsByType(t, st);
+    strncpy_P(name, eb_typeName(t), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    snprintf_P(line, sizeof(line), PSTR("%-8s%10lu%6u%6u"), name, (unsigned long)st.total,
+             (unsigned)st.perSec, (unsigned)st.drops);
+    DPRINTLN(line);
+  }
+}
+
+#endif // EB_STATS
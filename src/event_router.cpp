@@ -4,11 +4,14 @@
 #include "input_codes.h"
 #include "event_bus.h"
 #include "hal_buttons_simple.h"   // FnKey enums
+#include "latency_trace.h"
 #include <Arduino.h>
 #include <avr/pgmspace.h>
 
 static void deliverToContext(InputCode code) {
   if (auto* ctx = currentContext()) ctx->handleInput((int)code);
+  // Input almost always changes what's on screen (selection, values, ...)
+  if (auto* ctx = currentContext()) ctx->invalidate();
 }
 
 static void handleFnKey(uint8_t fn) {
@@ -26,13 +29,47 @@ static void handleFnKey(uint8_t fn) {
   }
 }
 
+// ---- Subscribers ----
+static void uiFnKeyDown(const Event& e) { handleFnKey((uint8_t)e.a); }
+
+// ---- Dispatch table ----
+// One null-terminated PROGMEM handler list per (source, type); several
+// modules may subscribe to the same event by sharing a list.
+static const EventHandler H_UI_FNKEY[] PROGMEM = { uiFnKeyDown, nullptr };
+
+#define H_NONE nullptr
+static const EventHandler* const ROUTES[SRC_COUNT][EVT_TYPE_COUNT] PROGMEM = {
+  //               NONE    KEY_DOWN    KEY_UP  POT_MOVE TICK_1MS TICK_24 CLOCK_SYNC BUS_ERROR
+  /* NONE     */ { H_NONE, H_UI_FNKEY, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },   // legacy src 0
+  /* FN_KEYS  */ { H_NONE, H_UI_FNKEY, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+  /* MATRIX_A */ { H_NONE, H_NONE,     H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+  /* MATRIX_B */ { H_NONE, H_NONE,     H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+  /* POTS     */ { H_NONE, H_NONE,     H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+  /* CLOCK    */ { H_NONE, H_NONE,     H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+  /* I2C      */ { H_NONE, H_NONE,     H_NONE, H_NONE, H_NONE, H_NONE, H_NONE, H_NONE },
+};
+#undef H_NONE
+static_assert(SRC_COUNT == 7 && EVT_TYPE_COUNT == 8, "update ROUTES for the new source/type");
+
+static void dispatch(const Event& e) {
+  if (e.src >= SRC_COUNT || e.type >= EVT_TYPE_COUNT) return;
+  const EventHandler* list = (const EventHandler*)pgm_read_ptr(&ROUTES[e.src][e.type]);
+  if (!list) return;
+  for (;;) {
+    const EventHandler h = (EventHandler)pgm_read_ptr(list++);
+    if (!h) break;
+    h(e);
+  }
+}
+
 void route_events() {
   Event e;
-  while (eb_pop(e)) {
-    // Accept only presses from function-key source
-    if (e.type == EVT_KEY_DOWN && (e.src == SRC_FN_KEYS || e.src == 0)) {
-      handleFnKey((uint8_t)e.a);
-    }
-    // Add other sources here later...
+  uint32_t pushedAt;
+  // eb_pop() hands out clock/transport first, then key edges, then the
+  // coalesced controls, re-checking the clock lane before every event.
+  while (eb_popStamped(e, pushedAt)) {
+    lat_routed(e, pushedAt);
+    dispatch(e);
+    lat_handled(e, pushedAt);
   }
 }
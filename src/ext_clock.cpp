@@ -0,0 +1,83 @@
+// ext_clock.cpp
+#include <Arduino.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "config.h"
+#include "ext_clock.h"
+#include "seq_clock.h"
+#include "timebase.h"
+
+#if PIN_EXT_CLOCK != 2
+#error "ext_clock expects PIN_EXT_CLOCK on pin 2 (INT4)"
+#endif
+#if (SEQ_CLOCK_PPQN % EXT_CLOCK_PPQN) != 0
+#error "SEQ_CLOCK_PPQN must be a multiple of EXT_CLOCK_PPQN"
+#endif
+
+static const uint8_t  TICKS_PER_EDGE = SEQ_CLOCK_PPQN / EXT_CLOCK_PPQN;
+static const uint32_t MIN_PERIOD_TB  = (uint32_t)EXT_CLOCK_MIN_PERIOD_US * TB_TICKS_PER_US;
+static const uint32_t MAX_PERIOD_TB  = (uint32_t)EXT_CLOCK_MAX_PERIOD_US * TB_TICKS_PER_US;
+
+static volatile uint32_t s_lastEdge = 0;   // timebase stamp of last accepted edge
+static volatile uint32_t s_est      = 0;   // filtered period (timebase ticks)
+static uint32_t s_hist[3];                 // last raw periods for the median
+static uint8_t  s_histN     = 0;
+static uint8_t  s_histIdx   = 0;
+static uint8_t  s_edges     = 0;           // accepted edges since (re)start
+static uint8_t  s_lockCount = 0;
+
+static inline uint32_t median3(uint32_t a, uint32_t b, uint32_t c) {
+  if (a > b) { uint32_t t = a; a = b; b = t; }
+  if (b > c) b = c;
+  return (a > b) ? a : b;
+}
+
+ISR(INT4_vect) {
+  const uint32_t now    = tb_nowISR();
+  const uint32_t period = now - s_lastEdge;
+
+  if (s_edges && period < MIN_PERIOD_TB) return;   // bounce / glitch
+  s_lastEdge = now;
+
+  if (!s_edges || period > MAX_PERIOD_TB) {
+    // First edge, or after a long silence: restart the estimate
+    s_edges = 1; s_histN = 0; s_lockCount = 0;
+    return;
+  }
+  if (s_edges < 255) s_edges++;
+
+  // Median-of-3 rejects single late/early edges, IIR (1/4) smooths the rest
+  s_hist[s_histIdx] = period;
+  s_histIdx = (uint8_t)((s_histIdx + 1) % 3);
+  if (s_histN < 3) s_histN++;
+  const uint32_t med = (s_histN < 3) ? period : median3(s_hist[0], s_hist[1], s_hist[2]);
+  if (s_histN == 1) s_est = med;
+  else              s_est = (uint32_t)((int32_t)s_est + ((int32_t)(med - s_est) / 4));
+
+  // Require a few consistent edges before taking over the clock
+  if (clk_following()) s_lockCount = 0;
+  else if (++s_lockCount < EXT_CLOCK_LOCK_EDGES) return;
+
+  clk_extEdgeFromISR(s_est, TICKS_PER_EDGE);
+}
+
+void xclk_init() {
+  pinMode(PIN_EXT_CLOCK, INPUT);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    // INT4 on rising edge
+    EICRB = (uint8_t)((EICRB & ~(_BV(ISC41) | _BV(ISC40))) | _BV(ISC41) | _BV(ISC40));
+    EIFR  = _BV(INTF4);
+    EIMSK |= _BV(INT4);
+  }
+}
+
+bool xclk_locked() { return clk_following(); }
+
+uint16_t xclk_bpm() {
+  uint32_t est;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { est = s_est; }
+  if (!est) return 0;
+  // 60 s per minute / (period per pulse * pulses per quarter)
+  return (uint16_t)((60UL * 1000000UL * TB_TICKS_PER_US) / (est * EXT_CLOCK_PPQN));
+}
@@ -1,6 +1,7 @@
 // hal_backlight.cpp
 #include <Arduino.h>
 #include "hal_backlight.h"
+#include "adc_scan.h"
 #include <avr/io.h>
 
 // Simple smoothing and rate limit to avoid flicker/jitter
@@ -33,8 +34,8 @@ static inline uint8_t adcToPwm(uint16_t v) {
 
 void hal_backlight_setup() {
   pinMode(PIN_BL_PWM, OUTPUT);
-  // Read initial pot to seed smoothing
-  uint16_t a0 = analogRead(PIN_BRIGHT_POT);
+  // Seed smoothing from the pot (adc_init has filled the table)
+  uint16_t a0 = adc_value(ADC_CH_BRIGHT);
   smoothAdc = a0;
   lastDuty = adcToPwm(smoothAdc);
   analogWrite(PIN_BL_PWM, lastDuty);
@@ -78,7 +79,7 @@ void hal_backlight_poll() {
   lastUpdateMs = now;
 
   // Read and smooth (simple IIR: 7/8 old + 1/8 new)
-  uint16_t raw = analogRead(PIN_BRIGHT_POT);
+  uint16_t raw = adc_value(ADC_CH_BRIGHT);
   smoothAdc = (uint16_t)(((uint32_t)smoothAdc * BL_SMOOTH_NUM + raw) / BL_SMOOTH_DEN);
 
   uint8_t duty = adcToPwm(smoothAdc);
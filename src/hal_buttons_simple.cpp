@@ -1,8 +1,10 @@
 // hal_buttons_simple.cpp
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "hal_buttons_simple.h"  // provides FnKey enum + prototypes
 #include "event_bus.h"           // eb_push(...)
 #include "config.h"              // BTN_SELECT/BTN_DOWN/BTN_UP/BTN_LIVE/BTN_BACK
+#include "LoopManager.h"
 #include "debug.h"
 
 // --------- Default pins if not overridden in config.h ----------
@@ -38,30 +40,64 @@ static inline void pushFn(FnKey key, bool isDown) {
   eb_push(e);
 }
 
-// One struct per button we watch
+// One entry per button we watch
 struct Btn {
   uint8_t pin;
-  uint8_t last;           // last stable level (HIGH/LOW)
-  unsigned long tLast;    // last time we toggled (for debounce)
+  uint8_t bit;            // FNKEY_PIN bit (board_profile)
   FnKey key;              // semantic key
   const char* name;       // for serial debug
 };
 
 // Our button table
-static Btn btns[] = {
-  { BTN_SELECT, HIGH, 0, FN_SELECT, "SELECT" },
-  { BTN_DOWN,   HIGH, 0, FN_DOWN,   "DOWN"   },
-  { BTN_UP,     HIGH, 0, FN_UP,     "UP"     },
-  { BTN_LIVE,   HIGH, 0, FN_LIVE,   "LIVE"   },
-  { BTN_BACK,   HIGH, 0, FN_BACK,   "BACK"   },
+static const Btn btns[] = {
+  { BTN_SELECT, BTN_SELECT_BIT, FN_SELECT, "SELECT" },
+  { BTN_DOWN,   BTN_DOWN_BIT,   FN_DOWN,   "DOWN"   },
+  { BTN_UP,     BTN_UP_BIT,     FN_UP,     "UP"     },
+  { BTN_LIVE,   BTN_LIVE_BIT,   FN_LIVE,   "LIVE"   },
+  { BTN_BACK,   BTN_BACK_BIT,   FN_BACK,   "BACK"   },
 };
 
+static const uint8_t FNKEY_MASK = _BV(BTN_SELECT_BIT) | _BV(BTN_DOWN_BIT) | _BV(BTN_UP_BIT) |
+                                  _BV(BTN_LIVE_BIT) | _BV(BTN_BACK_BIT);
+
+// Debouncer state, one bit per port bit (1 = pressed). The vertical
+// counter is two bit-planes; written only by the sampler ISR.
+static volatile uint8_t s_state = 0;
+static uint8_t s_ct0 = 0xFF, s_ct1 = 0xFF;
+// Edges not yet published (ISR sets, poll clears)
+static volatile uint8_t s_down = 0, s_up = 0;
+static int8_t s_task = -1;
+
+ISR(TIMER0_COMPB_vect) {
+#if BTN_SAMPLE_DIV > 1
+  static uint8_t div = 0;
+  if (++div < BTN_SAMPLE_DIV) return;
+  div = 0;
+#endif
+  const uint8_t raw = (uint8_t)~FNKEY_PIN & FNKEY_MASK;   // pull-ups: low = pressed
+  uint8_t i = s_state ^ raw;        // bits that disagree with the debounced state
+  s_ct0 = ~(s_ct0 & i);             // count down while they disagree,
+  s_ct1 = s_ct0 ^ (s_ct1 & i);      // reset to 3 as soon as they agree
+  i &= s_ct0 & s_ct1;               // rolled over: 4 samples in a row
+  if (!i) return;
+  const uint8_t st = s_state ^ i;
+  s_state = st;
+  s_down |= st & i;
+  s_up   |= (uint8_t)~st & i;
+  triggerLoopTask(s_task);
+}
+
+static void checkPin(uint8_t pin, uint8_t bit) {
+  if (portInputRegister(digitalPinToPort(pin)) != &FNKEY_PIN ||
+      digitalPinToBitMask(pin) != _BV(bit)) {
+    DL("buttons: pin "); DPRINT(pin); DLLN(" doesn't match board_profile port bit");
+  }
+}
+
 void hal_buttons_setup() {
-  pinMode(BTN_SELECT, INPUT_PULLUP);
-  pinMode(BTN_DOWN,   INPUT_PULLUP);
-  pinMode(BTN_UP,     INPUT_PULLUP);
-  pinMode(BTN_LIVE,   INPUT_PULLUP);
-  pinMode(BTN_BACK,   INPUT_PULLUP);
+  for (const auto& b : btns) checkPin(b.pin, b.bit);
+  FNKEY_DDR  &= (uint8_t)~FNKEY_MASK;   // inputs
+  FNKEY_PORT |= FNKEY_MASK;             // with pull-ups
 
   // Announce which pins we're watching
   DL("BTN_SELECT="); DPRINTLN(BTN_SELECT);
@@ -70,36 +106,35 @@ void hal_buttons_setup() {
   DL("BTN_LIVE=");   DPRINTLN(BTN_LIVE);
   DL("BTN_BACK=");   DPRINTLN(BTN_BACK);
 
+  // Timer0 keeps running for millis(); compare B only adds an interrupt
+  // half way through each overflow period.
+  OCR0B   = 0x80;
+  TIFR0   = _BV(OCF0B);
+  TIMSK0 |= _BV(OCIE0B);
 }
 
-void hal_buttons_poll() {
-  const unsigned long now = millis();
+void hal_buttons_setTask(int8_t taskId) {
+  s_task = taskId;
+  triggerLoopTask(taskId);   // pick up anything debounced before now
+}
 
-  // Raw level dump every ~500 ms (helps when probing with a GND wire)
- static unsigned long lastDump = 0;
-  if (now - lastDump > 500) {
-    lastDump = now;
-    DL("RAW ");
-    for (auto &b : btns) {
-      DPRINT(b.name); DL("="); 
-      DPRINT(digitalRead(b.pin) == LOW ? "L " : "H ");  // runtime string → no F()
-    }
-    DPRINTLN(""); // newline
+void hal_buttons_poll() {
+  uint8_t down, up, st;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    down = s_down; up = s_up; st = s_state;
+    s_down = 0; s_up = 0;
   }
+  if (!(down | up)) return;
 
-  // Debounce + edge detection (25 ms)
-  for (auto &b : btns) {
-    uint8_t v = digitalRead(b.pin); // HIGH = released, LOW = pressed (INPUT_PULLUP)
-    if (v != b.last && (now - b.tLast) >= 25) {
-      b.tLast = now;
-      b.last  = v;
-
-      
+  for (const auto& b : btns) {
+    const uint8_t m = _BV(b.bit);
+    if (!((down | up) & m)) continue;
+    // Both edges since the last poll: the current level says which came last
+    const bool pressed = st & m;
+    if ((down & up & m)) pushFn(b.key, !pressed);
+    pushFn(b.key, pressed);
 
-       DL("EDGE "); DPRINT(b.name);
-      DPRINTLN(v == LOW ? " DOWN" : " UP");
-      
-      pushFn(b.key, v == LOW);
-    }
+    DL("EDGE "); DPRINT(b.name);
+    DPRINTLN(pressed ? " DOWN" : " UP");
   }
 }
@@ -0,0 +1,84 @@
+// latency_trace.cpp
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "latency_trace.h"
+
+#if LAT_TRACE
+
+#include "timebase.h"
+#include "debug.h"
+
+static ProfStat s_path[LAT_PATH_COUNT];
+
+// Press-to-screen: the oldest handled key edge not yet on the glass. It
+// is armed by the handler, latched by the next draw (a frame that was
+// already in flight can't show it) and booked once that frame is sent.
+// Edges handled while one is armed ride along with it untraced.
+enum FrameTrace : uint8_t { FT_IDLE = 0, FT_ARMED, FT_DRAWN };
+static FrameTrace s_ft = FT_IDLE;
+static uint32_t   s_ftPushedAt;
+
+static const char LN_KEY_ROUTE[]   PROGMEM = "key>rte";
+static const char LN_KEY_HANDLE[]  PROGMEM = "key>hdl";
+static const char LN_KEY_FRAME[]   PROGMEM = "key>lcd";
+static const char LN_CTRL_ROUTE[]  PROGMEM = "pot>rte";
+static const char LN_CLOCK_ROUTE[] PROGMEM = "clk>rte";
+static const char* const PATH_NAMES[LAT_PATH_COUNT] PROGMEM = {
+  LN_KEY_ROUTE, LN_KEY_HANDLE, LN_KEY_FRAME, LN_CTRL_ROUTE, LN_CLOCK_ROUTE
+};
+
+static inline void record(uint8_t path, uint32_t pushedAt) {
+  prof_statAdd(s_path[path], tb_to_us(tb_now() - pushedAt));
+}
+
+void lat_routed(const Event& e, uint32_t pushedAt) {
+  switch (eb_laneOf(e.type)) {
+    case LANE_CLOCK:   record(LAT_CLOCK_ROUTE, pushedAt); break;
+    case LANE_KEYS:    record(LAT_KEY_ROUTE,   pushedAt); break;
+    case LANE_CONTROL: record(LAT_CTRL_ROUTE,  pushedAt); break;
+    default: break;
+  }
+}
+
+void lat_handled(const Event& e, uint32_t pushedAt) {
+  if (eb_laneOf(e.type) != LANE_KEYS) return;
+  record(LAT_KEY_HANDLE, pushedAt);
+  if (e.type == EVT_KEY_DOWN && s_ft == FT_IDLE) {
+    s_ft = FT_ARMED;
+    s_ftPushedAt = pushedAt;
+  }
+}
+
+void lat_frameBegin() {
+  if (s_ft == FT_ARMED) s_ft = FT_DRAWN;
+}
+
+void lat_frameFlushed() {
+  if (s_ft != FT_DRAWN) return;
+  record(LAT_KEY_FRAME, s_ftPushedAt);
+  s_ft = FT_IDLE;
+}
+
+void lat_reset() {
+  memset(s_path, 0, sizeof(s_path));
+  s_ft = FT_IDLE;
+}
+
+const ProfStat* lat_path(uint8_t path) {
+  return (path < LAT_PATH_COUNT) ? &s_path[path] : nullptr;
+}
+
+const char* lat_pathName(uint8_t path) {
+  return (path < LAT_PATH_COUNT) ? (const char*)pgm_read_ptr(&PATH_NAMES[path]) : nullptr;
+}
+
+void lat_dump() {
+  DLLN("-- latency (us from push) --  path n min avg max | " PROF_HIST_LEGEND);
+  char name[12];
+  for (uint8_t i = 0; i < LAT_PATH_COUNT; ++i) {
+    strncpy_P(name, lat_pathName(i), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    prof_dumpRow(name, s_path[i]);
+  }
+}
+
+#endif // LAT_TRACE
@@ -1,5 +1,7 @@
 // main.cpp
 // Startup sketch for modular context engine
+// (left out of `pio test` builds; the test brings its own setup/loop)
+#ifndef PIO_UNIT_TESTING
 #include <Arduino.h>
 #include "config.h"
 #include "context_registry.h"
@@ -12,6 +14,20 @@
 #include "hal_backlight.h"
 #include "settings_store.h"
 #include "event_router.h"
+#include "render_gate.h"
+#include "seq_clock.h"
+#include "ext_clock.h"
+#include "timebase.h"
+#include "profiler.h"
+#include "debug_console.h"
+#include "LoopManager.h"
+#include "step_pots_4067.h"
+#include "adc_scan.h"
+#include "button_matrix.h"
+#include "twi.h"
+#include "display_st7920.h"
+#include "latency_trace.h"
+#include "ram_stats.h"
 #include <avr/wdt.h>
 #include <avr/io.h>
 #include <avr/pgmspace.h>
@@ -19,9 +35,89 @@
 
 // Optional display object
 #include <U8g2lib.h>
+// Transport and buffer mode are picked in display_st7920.h
+#if DISP_TRANSPORT != DISP_TRANSPORT_U8G2
+U8G2_ST7920_128X64_FAST U8G2(U8G2_R0);
+#elif DISP_FULL_BUFFER
+U8G2_ST7920_128X64_F_SW_SPI U8G2(U8G2_R0, LCD_CLK, LCD_MOSI, LCD_CS);
+#else
 U8G2_ST7920_128X64_1_SW_SPI U8G2(U8G2_R0, LCD_CLK, LCD_MOSI, LCD_CS);
-//U8G2_ST7920_128X64_1_HW_SPI U8G2(U8G2_R0, /* cs=*/ 53);
+#endif
+
+// ---- Loop tasks ----
+static const char TN_EVENTS[]    PROGMEM = "events";
+static const char TN_BUTTONS[]   PROGMEM = "buttons";
+static const char TN_BACKLIGHT[] PROGMEM = "backlight";
+static const char TN_DISPLAY[]   PROGMEM = "display";
+#if DISP_ASYNC_FLUSH
+static const char TN_LCD[]       PROGMEM = "lcd";
+#endif
+static const char TN_STORAGE[]   PROGMEM = "storage";
+static const char TN_DEBUG[]     PROGMEM = "debug";
+
+static void taskEvents()    { PROF_RUN(PROF_ROUTE, { clk_poll(); route_events(); }); }   // sync loss, consume + deliver
+static void taskButtons() {   // produce events
+#if USE_BUTTON_MATRIX
+  PROF_RUN(PROF_BUTTONS, { hal_buttons_poll(); twi_poll(); btnmx_poll(); });
+#else
+  PROF_RUN(PROF_BUTTONS, { hal_buttons_poll(); twi_poll(); });
+#endif
+}
+static void taskBacklight() { PROF_RUN(PROF_BACKLIGHT, hal_backlight_poll()); } // screen backlight from pot
+
+static void taskDisplay() {
+  if (auto* ctx = currentContext()) {
+    PROF_RUN(PROF_UPDATE, ctx->update(&U8G2));
+    // Only push a frame when something changed (and not faster than the cap),
+    // and never over one that's still being sent
+    if (!disp_busy() && render_frame_due(ctx)) {
+      lat_frameBegin();
+      disp_frameBegin();
+      PROF_RUN_CTX(PROF_DRAW, ctx, ctx->draw(&U8G2));
+      disp_frameEnd(ctx);
+      if (!disp_busy()) lat_frameFlushed();   // sent synchronously
+    }
+  }
+}
+
+#if DISP_ASYNC_FLUSH
+static void taskLcd() {
+  if (!disp_pump(DISP_PUMP_BUDGET_US)) lat_frameFlushed();
+}
+#endif
+
+static void taskDebug() {
+  eb_statsPoll();
+  render_stats_poll();
+  console_poll();
+}
+
+static void registerTasks() {
+  // Event delivery runs every pass and is also woken by each clock tick, so
+  // tick-driven output always goes out before the next redraw.
+  const int8_t evt = registerLoopTask(TN_EVENTS, taskEvents, 0, PRIO_OUTPUT, 500);
+  clk_setTickTask(evt);
+  // Buttons only run when the key sampler has debounced an edge, the
+  // matrix expander raised its interrupt or an I2C job finished
+  const int8_t btn = registerLoopTask(TN_BUTTONS, taskButtons, TASK_ON_DEMAND, PRIO_INPUT, 300);
+  twi_setTask(btn);
+#if USE_BUTTON_MATRIX
+  btnmx_setTask(btn);
+#endif
+  hal_buttons_setTask(btn);
+  registerLoopTask(TN_BACKLIGHT, taskBacklight, 20, PRIO_CONTROL,    200);
+#if DISP_ASYNC_FLUSH
+  registerLoopTask(TN_DISPLAY,   taskDisplay,   0,  PRIO_UI,        8000);
+  registerLoopTask(TN_LCD,       taskLcd,       0,  PRIO_UI,  DISP_PUMP_BUDGET_US + 500);
+#else
+  registerLoopTask(TN_DISPLAY,   taskDisplay,   0,  PRIO_UI,       40000);
+#endif
+  registerLoopTask(TN_STORAGE,   settings_service, 50, PRIO_BACKGROUND, 4000);
+  registerLoopTask(TN_DEBUG,     taskDebug,     20, PRIO_BACKGROUND, 2000);
+}
+
 void setup() {
+  ram_paint();          // before anything deepens the stack
   //Serial.begin(115200);
   DEBUG_BEGIN();
   hal_buttons_setup();
@@ -29,15 +125,35 @@ void setup() {
   
   // Init display
   U8G2.begin();
+  disp_attach(&U8G2);   // our transport (and row diff, if on) from here on
+
+  // Free-running timebase (Timer5) for timestamps
+  tb_init();
+
+  // Sequencer clock (Timer3) — configured stopped, tempo comes from settings
+  clk_init();
+#if USE_EXT_CLOCK
+  xclk_init();
+#endif
 
   // Load settings from EEPROM and apply runtime knobs
   settings_init();
 
+  // Pots are scanned from ADC_vect from here on (step mux, instrument,
+  // brightness); no analogRead() after this
+#if USE_4067_STEPPOTS
+  stepPots_init();
+#endif
+  adc_init();
+
   // Init backlight PWM + seed from brightness pot
   hal_backlight_setup();
 
-  // Init input manager (this sets up pins for all inputs declared in config)
-  //initInputManager();
+  // Interrupt-driven I2C (matrix expander, diagnostics)
+  twi_init(TWI_HZ);
+#if USE_BUTTON_MATRIX
+  btnmx_init();
+#endif
 
   // Register contexts (menus, live mode, etc.)
   registerAllContexts();
@@ -45,18 +161,15 @@ void setup() {
   // Start in LIVE mode (grid) instead of BOOT
   setContextByName_P(PSTR("LIVE_MODE"));
 
+  registerTasks();
+
+  ram_dump();
   DL("Setup complete.");
 }
 
 
 void loop() {
-  hal_buttons_poll();  // produce events
-  hal_backlight_poll(); // update screen backlight from pot
-  route_events();      // consume + deliver
-  if (currentContext()) {
-    if (auto* ctx = currentContext()) {
-      ctx->update(&U8G2);
-      ctx->draw(&U8G2);
-    }
-  }
+  PROF_RUN(PROF_LOOP, runLoopTasks());
 }
+
+#endif // PIO_UNIT_TESTING
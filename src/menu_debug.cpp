@@ -4,27 +4,61 @@
 #include <U8g2lib.h>
 #include <avr/pgmspace.h>
 #include "ui_draw.h"
-#include "events.h"
 #include "transitions.h"
-#include <Wire.h>
 #include <SPI.h>
 #include <SD.h>
 #include "config_pins.h"
 #include "hal_backlight.h"
+#include "profiler.h"
+#include "LoopManager.h"
+#include "event_bus.h"
+#include "latency_trace.h"
+#include "twi.h"
+#include "ram_stats.h"
 
 
 // ----- PROGMEM labels -----
 const char D_ITEM_0[] PROGMEM = "System Info";
 const char D_ITEM_1[] PROGMEM = "Test Beep";
+const char D_ITEM_TASKS[] PROGMEM = "Tasks";
+#if EB_STATS
+const char D_ITEM_EVENTS[] PROGMEM = "Events";
+#endif
+#if PROF_ENABLED
+const char D_ITEM_PROF[] PROGMEM = "Profiler";
+#endif
+#if LAT_TRACE
+const char D_ITEM_LAT[] PROGMEM = "Latency";
+#endif
 const char D_ITEM_2[] PROGMEM = "Back";
 const char* const MENU_DEBUG_ITEMS[] PROGMEM = {
-  D_ITEM_0, D_ITEM_1, D_ITEM_2
+  D_ITEM_0, D_ITEM_1, D_ITEM_TASKS,
+#if EB_STATS
+  D_ITEM_EVENTS,
+#endif
+#if PROF_ENABLED
+  D_ITEM_PROF,
+#endif
+#if LAT_TRACE
+  D_ITEM_LAT,
+#endif
+  D_ITEM_2
 };
 
 // ----- PROGMEM destinations -----
 const char* const MENU_DEBUG_SUBS[] PROGMEM = {
   "SYS_INFO",
   "TEST_BEEP",
+  "TASKS",
+#if EB_STATS
+  "EVENTS",
+#endif
+#if PROF_ENABLED
+  "PROFILER",
+#endif
+#if LAT_TRACE
+  "LATENCY",
+#endif
   "MAIN_MENU",
 };
 static const uint8_t MENU_DEBUG_COUNT =
@@ -39,8 +73,7 @@ DebugMenuContext::DebugMenuContext()
 
 void DebugMenuContext::draw(void* gfx) {
   U8G2* gfxU8 = (U8G2*)gfx;
-  char t[24]; strncpy_P(t, TITLE_DEBUG, sizeof(t)-1); t[sizeof(t)-1] = '\0';
-  drawMenuPagedP(gfxU8, t, items, itemCount, selectedIndex, 4);
+  drawMenuPagedP_P(gfxU8, TITLE_DEBUG, items, itemCount, selectedIndex, 4);
 }
 
 void DebugMenuContext::handleInput(int input) {
@@ -76,6 +109,7 @@ public:
     if (ran) return;
     ran = true;
     runDiagnostics();
+    invalidate();
     showUntil = millis() + 8000; // show results ~8s
   }
   void draw(void* gfx) override {
@@ -85,11 +119,11 @@ public:
     do {
       drawTitleWithLines_P(g, T_SYSINFO, 12, 6);
       g->setFont(u8g2_font_6x10_tf);
-      // Render up to 5 lines of results
+      // Render up to LINES lines of results
       int y = 26;
       const int lineH = 12;
       const char* p = result;
-      for (int lines = 0; lines < 5 && *p; ++lines) {
+      for (int lines = 0; lines < LINES && *p; ++lines) {
         const char* nl = strchr(p, '\n');
         char buf[48];
         if (!nl) {
@@ -116,12 +150,22 @@ public:
     }
   }
 private:
+  // What fits under the title; lines are cut to the screen width
+  static const uint8_t LINES = 5;
   bool ran;
   unsigned long showUntil;
-  char result[192];
+  char result[LINES * UI_TEXT_MAX + 1];
 
   void append(const char* s) {
-    strncat(result, s, sizeof(result)-strlen(result)-1);
+    size_t n = strlen(result);
+    const char* nl = strrchr(result, '\n');
+    size_t col = nl ? (size_t)(result + n - nl - 1) : n;
+    for (; *s && n < sizeof(result) - 1; ++s) {
+      if (*s == '\n') col = 0;
+      else if (col++ >= UI_TEXT_MAX - 1) continue;
+      result[n++] = *s;
+    }
+    result[n] = '\0';
   }
   void appendP(const char* sP) {
     char buf[64];
@@ -149,16 +193,18 @@ private:
     static const char M_DONE[] PROGMEM = "Done.";
     // No intro line to keep key info within first page
 
-    // I2C scan
-    Wire.begin();
+    // Stack headroom first: it's what runs out on an 8 KB part
+    {
+      char b[24]; snprintf_P(b, sizeof(b), PSTR("RAM free %u min %u"), (unsigned)ram_free(), (unsigned)ram_minFree()); appendLine(b);
+    }
+
+    // I2C scan (probes go through the TWI queue; a dead bus times out)
     appendP(M_I2C);
     bool any = false;
     for (uint8_t addr = 1; addr < 127; ++addr) {
-      Wire.beginTransmission(addr);
-      uint8_t err = Wire.endTransmission();
-      if (err == 0) {
+      if (probeI2C(addr)) {
         any = true;
-        char b[8]; snprintf(b, sizeof(b), "0x%02X ", addr);
+        char b[8]; snprintf_P(b, sizeof(b), PSTR("0x%02X "), addr);
         append(b);
       }
     }
@@ -176,7 +222,7 @@ private:
     bool eep = false; uint8_t eepAddr = 0x50;
     for (uint8_t a = 0x50; a <= 0x57; ++a) { if (probeI2C(a)) { eep = true; eepAddr = a; break; } }
     if (eep) {
-      char b[24]; snprintf(b, sizeof(b), "EEPROM @0x%02X: OK", eepAddr); appendLine(b);
+      char b[24]; snprintf_P(b, sizeof(b), PSTR("EEPROM @0x%02X: OK"), eepAddr); appendLine(b);
     } else {
       appendLineP(M_ENOK);
     }
@@ -200,10 +246,7 @@ private:
     appendLineP(M_DONE);
   }
 
-  static bool probeI2C(uint8_t addr) {
-    Wire.beginTransmission(addr);
-    return (Wire.endTransmission() == 0);
-  }
+  static bool probeI2C(uint8_t addr) { return twi_probeSync(addr); }
 
   void readTextFileToResult() {
     const char* candidates[] = { "/system.txt", "/info.txt" };
@@ -280,10 +323,10 @@ public:
     do {
       drawTitleWithLines_P(g, T_BEEP, 12, 6);
       g->setFont(u8g2_font_6x10_tf);
-      char line1[28]; snprintf(line1, sizeof(line1), "Freq: %u Hz", (unsigned)freq);
+      char line1[28]; snprintf_P(line1, sizeof(line1), PSTR("Freq: %u Hz"), (unsigned)freq);
 #ifdef PIN_BUZZER
       static const char MSG_CTRL[]    PROGMEM = "Select=Beep  Up/Down=Adj  Back";
-      char line2[28]; snprintf(line2, sizeof(line2), "Pin: %u", (unsigned)PIN_BUZZER);
+      char line2[28]; snprintf_P(line2, sizeof(line2), PSTR("Pin: %u"), (unsigned)PIN_BUZZER);
       g->drawStr(4, 30, line1);
       g->drawStr(4, 42, line2);
       drawProgmemStr(g, 4, 54, MSG_CTRL);
@@ -315,3 +358,219 @@ private:
 
 static TestBeepContext testBeepContext;
 void registerTestBeepContext() { registerContext("TEST_BEEP", &testBeepContext); }
+
+// -------------------------
+// Scrolling table page: title, a window of text rows with the selection
+// inverted, optional footer. Repaints every 500 ms since the numbers move
+// on their own; SELECT dumps the full table over serial.
+// -------------------------
+class TableContext : public ContextObject {
+public:
+  TableContext(const char* name_in, const char* titleP_in, uint8_t rowsVisible_in)
+    : ContextObject(name_in, "DEBUG", nullptr, 0),
+      sel(0), titleP(titleP_in), rowsVisible(rowsVisible_in), top(0), lastRefresh(0) {}
+  void update(void* /*gfx*/) override {
+    const unsigned long now = millis();
+    if ((now - lastRefresh) >= 500) { lastRefresh = now; invalidate(); }
+  }
+  void draw(void* gfx) override {
+    U8G2* g = (U8G2*)gfx;
+    g->firstPage();
+    do {
+      drawTitleWithLines_P(g, titleP, 12, 6);
+      g->setFont(u8g2_font_5x7_tf);
+      const uint8_t n = rowCount();
+      for (uint8_t r = 0; r < rowsVisible && (top + r) < n; ++r) {
+        const uint8_t i = top + r;
+        const int y = 21 + r * 8;
+        char line[28];
+        rowText(i, line, sizeof(line));
+        if (i == sel) { g->drawBox(0, y - 7, 128, 8); g->setDrawColor(0); }
+        g->drawStr(1, y, line);
+        if (i == sel) g->setDrawColor(1);
+      }
+      drawFooter(g);
+    } while (g->nextPage());
+  }
+  void handleInput(int input) override {
+    if (input == KEY_BACK) { (void)goBack(); return; }
+    if (input == KEY_DOWN && (sel + 1) < rowCount()) sel++;
+    else if (input == KEY_UP && sel > 0) sel--;
+    else if (input == KEY_SELECT) dump();
+    if (sel < top) top = sel;
+    if (sel >= top + rowsVisible) top = (uint8_t)(sel - rowsVisible + 1);
+  }
+protected:
+  uint8_t sel;
+  virtual uint8_t rowCount() const = 0;
+  virtual void rowText(uint8_t i, char* line, size_t n) const = 0;
+  virtual void drawFooter(U8G2* /*g*/) const {}   // below the rows, about the selection
+  virtual void dump() const = 0;
+private:
+  const char* titleP;
+  uint8_t rowsVisible, top;
+  unsigned long lastRefresh;
+};
+
+#if PROF_ENABLED
+// Bars 14 px wide on a 16 px pitch from x, bottoms on y, scaled to the
+// tallest bin
+static void drawHistogram(U8G2* g, const uint8_t* hist, uint8_t bins, int x, int y) {
+  uint8_t peak = 1;
+  for (uint8_t b = 0; b < bins; ++b) if (hist[b] > peak) peak = hist[b];
+  for (uint8_t b = 0; b < bins; ++b) {
+    const uint8_t h = (uint8_t)((uint16_t)hist[b] * 14u / peak);
+    if (h) g->drawBox(x + b * 16, y - h, 14, h);
+  }
+}
+
+// name min avg max, or a dash before the first sample
+static void statRowText(char* line, size_t n, const char* name, const ProfStat* s) {
+  if (s && s->count) {
+    snprintf_P(line, n, PSTR("%-7.7s%6u%6u%6u"), name, (unsigned)s->minUs,
+             (unsigned)(s->sumUs / s->count), (unsigned)s->maxUs);
+  } else {
+    snprintf_P(line, n, PSTR("%-7.7s     -"), name);
+  }
+}
+#endif // PROF_ENABLED
+
+// -------------------------
+// Scheduler task page (budget overruns)
+// -------------------------
+static const char T_TASKS[] PROGMEM = "Tasks max ovr miss";
+class TasksContext : public TableContext {
+public:
+  TasksContext() : TableContext("TASKS", T_TASKS, 4) {}
+protected:
+  uint8_t rowCount() const override { return loopTaskCount(); }
+  // name maxUs overruns misses
+  void rowText(uint8_t i, char* line, size_t n) const override {
+    const LoopTask* t = loopTask(i);
+    char name[10];
+    strncpy_P(name, t->nameP, sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    snprintf_P(line, n, PSTR("%-9.9s%6u%5u%5u"), name,
+             (unsigned)t->maxUs, (unsigned)t->overruns, (unsigned)t->misses);
+  }
+  // Budget of the selected task along the bottom
+  void drawFooter(U8G2* g) const override {
+    if (const LoopTask* t = loopTask(sel)) {
+      char foot[28];
+      snprintf_P(foot, sizeof(foot), PSTR("budget %uus last %u"), (unsigned)t->budgetUs, (unsigned)t->lastUs);
+      g->drawStr(1, 63, foot);
+    }
+  }
+  void dump() const override { dumpLoopTasks(); }
+};
+
+static TasksContext tasksContext;
+void registerTasksContext() { registerContext("TASKS", &tasksContext); }
+
+#if EB_STATS
+// -------------------------
+// Event bus telemetry page
+// -------------------------
+static const char T_EVENTS[] PROGMEM = "Events tot /s drop";
+class EventsContext : public TableContext {
+public:
+  EventsContext() : TableContext("EVENTS", T_EVENTS, 5) {}
+protected:
+  uint8_t rowCount() const override { return ROW_COUNT; }
+  void dump() const override { eb_statsDump(); }
+private:
+  // Rings, coalesced controls, then sources, then types
+  static const uint8_t ROW_COUNT = PROD_COUNT + 1 + SRC_COUNT + EVT_TYPE_COUNT;
+
+  void rowText(uint8_t i, char* line, size_t n) const override {
+    char name[10];
+    if (i < PROD_COUNT) {
+      strncpy_P(name, eb_producerName(i), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+      snprintf_P(line, n, PSTR("%-7.7s%3u/%-3u hw%-3u%5u"), name, (unsigned)eb_ringUsed(i),
+               (unsigned)eb_ringLen(i), (unsigned)eb_ringHighWater(i), (unsigned)eb_ringDrops(i));
+      return;
+    }
+    i -= PROD_COUNT;
+    if (i == 0) { snprintf_P(line, n, PSTR("ctrl coalesced %u"), (unsigned)eb_ctrlCoalesced()); return; }
+    i -= 1;
+    EbStat st;
+    if (i < SRC_COUNT) {
+      eb_statsBySource(i, st);
+      strcpy(name, "s:");
+      strncpy_P(name + 2, eb_sourceName(i), sizeof(name) - 3);
+    } else {
+      i -= SRC_COUNT;
+      eb_statsByType(i, st);
+      strcpy(name, "t:");
+      strncpy_P(name + 2, eb_typeName(i), sizeof(name) - 3);
+    }
+    name[sizeof(name) - 1] = '\0';
+    snprintf_P(line, n, PSTR("%-8.8s%6lu%5u%5u"), name, (unsigned long)st.total,
+             (unsigned)st.perSec, (unsigned)st.drops);
+  }
+};
+
+static EventsContext eventsContext;
+void registerEventsContext() { registerContext("EVENTS", &eventsContext); }
+#endif // EB_STATS
+
+#if PROF_ENABLED
+// -------------------------
+// Loop profiler page
+// -------------------------
+static const char T_PROF[] PROGMEM = "Profiler us";
+class ProfilerContext : public TableContext {
+public:
+  ProfilerContext() : TableContext("PROFILER", T_PROF, 4) {}
+protected:
+  // Stages first, then one row per registered context (draw time)
+  uint8_t rowCount() const override { return (uint8_t)(PROF_STAGE_COUNT + getRegisteredContextCount()); }
+  void rowText(uint8_t i, char* line, size_t n) const override {
+    char name[12];
+    if (i < PROF_STAGE_COUNT) {
+      strncpy_P(name, prof_stageName(i), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    } else {
+      ContextObject* ctx = getContextByIndex((uint8_t)(i - PROF_STAGE_COUNT));
+      strncpy(name, ctx ? ctx->name : "?", sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    }
+    statRowText(line, n, name, rowStat(i));
+  }
+  // Histogram of the selected row along the bottom
+  void drawFooter(U8G2* g) const override {
+    if (const ProfStat* s = rowStat(sel)) drawHistogram(g, s->hist, PROF_HIST_BINS, 1, 63);
+  }
+  void dump() const override { prof_dump(); }
+private:
+  static const ProfStat* rowStat(uint8_t i) {
+    return (i < PROF_STAGE_COUNT) ? prof_stage(i) : prof_context((uint8_t)(i - PROF_STAGE_COUNT));
+  }
+};
+
+static ProfilerContext profilerContext;
+void registerProfilerContext() { registerContext("PROFILER", &profilerContext); }
+#endif // PROF_ENABLED
+
+#if LAT_TRACE
+// -------------------------
+// Latency tracer page
+// -------------------------
+static const char T_LAT[] PROGMEM = "Latency us";
+class LatencyContext : public TableContext {
+public:
+  LatencyContext() : TableContext("LATENCY", T_LAT, 4) {}
+protected:
+  uint8_t rowCount() const override { return LAT_PATH_COUNT; }
+  void rowText(uint8_t i, char* line, size_t n) const override {
+    char name[10];
+    strncpy_P(name, lat_pathName(i), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    statRowText(line, n, name, lat_path(i));
+  }
+  // Histogram of the selected path along the bottom
+  void drawFooter(U8G2* g) const override {
+    if (const ProfStat* s = lat_path(sel)) drawHistogram(g, s->hist, PROF_HIST_BINS, 1, 63);
+  }
+  void dump() const override { lat_dump(); }
+};
+
+static LatencyContext latencyContext;
+void registerLatencyContext() { registerContext("LATENCY", &latencyContext); }
+#endif // LAT_TRACE
@@ -9,63 +9,38 @@
 DisplayOptionsContext::DisplayOptionsContext()
   : ContextObject("DISPLAY_OPTIONS", "SETTINGS", nullptr, 0), sel(0), initialized(false), maxPct(100), invert(false) {}
 
+static const char T_DISP_OPTS[]   PROGMEM = "Display Options";
+static const char L_MAX_BRIGHT[]  PROGMEM = "Max Brightness";
+static const char L_INVERT[]      PROGMEM = "Invert";
+static const char L_UNICORN[]     PROGMEM = "Unicorn";
+static const char L_SAVE[]        PROGMEM = "Save";
+static const char* const DISP_LABELS[] PROGMEM = { L_MAX_BRIGHT, L_INVERT, L_UNICORN, L_SAVE };
+static const char V_ON[]          PROGMEM = "On";
+static const char V_OFF[]         PROGMEM = "Off";
+static const char V_UNICORN[]     PROGMEM = "UNiCORN!";
+
+void DisplayOptionsContext::refreshText() {
+  snprintf_P(pctText, sizeof(pctText), PSTR("%u%%"), (unsigned)maxPct);
+  strcpy_P(invText, invert ? V_ON : V_OFF);
+  strcpy_P(uniText, V_UNICORN);
+}
+
 void DisplayOptionsContext::update(void* /*gfx*/) {
   // Always reflect latest settings so sub-screens edits show here.
   auto& s = settings_get();
-  maxPct = s.bl_max_percent;
-  invert = (s.bl_invert != 0);
-  initialized = true;
-}
-
-static void drawLine(U8G2* g, int y, const char* label, const char* value, bool sel) {
-  if (sel) { g->drawBox(0, y - 10, 128, 12); g->setDrawColor(0); }
-  g->drawStr(4, y, label);
-  if (value) {
-    int w = g->getDisplayWidth();
-    int tw = g->getUTF8Width(value);
-    g->drawStr(w - tw - 4, y, value);
+  const bool inv = (s.bl_invert != 0);
+  if (!initialized || maxPct != s.bl_max_percent || invert != inv) {
+    maxPct = s.bl_max_percent;
+    invert = inv;
+    refreshText();
   }
-  if (sel) { g->setDrawColor(1); }
+  initialized = true;
 }
 
 void DisplayOptionsContext::draw(void* gfx) {
-  static const char T_DISP_OPTS[]   PROGMEM = "Display Options";
-  static const char L_MAX_BRIGHT[]  PROGMEM = "Max Brightness";
-  static const char L_INVERT[]      PROGMEM = "Invert";
-  static const char L_UNICORN[]     PROGMEM = "Unicorn";
-  static const char L_SAVE[]        PROGMEM = "Save";
-  static const char L_SAVE_SEL[]    PROGMEM = "> Save";
-  static const char V_ON[]          PROGMEM = "On";
-  static const char V_OFF[]         PROGMEM = "Off";
-  static const char V_UNICORN[]     PROGMEM = "UNiCORN!";
-
-  U8G2* g = (U8G2*)gfx;
-  g->firstPage();
-  do {
-    drawTitleWithLines_P(g, T_DISP_OPTS, 12, 6);
-    g->setFont(u8g2_font_6x10_tf);
-
-    char v1[8]; snprintf(v1, sizeof(v1), "%u%%", (unsigned)maxPct);
-    char lab[20];
-
-    // Max Brightness
-    strncpy_P(lab, L_MAX_BRIGHT, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    drawLine(g, 26, lab, v1, sel == 0);
-
-    // Invert line with PROGMEM values
-    strncpy_P(lab, L_INVERT, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    char v2[8]; strcpy_P(v2, invert ? V_ON : V_OFF);
-    drawLine(g, 38, lab, v2, sel == 1);
-
-    // Unicorn
-    strncpy_P(lab, L_UNICORN, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    char v3[16]; strcpy_P(v3, V_UNICORN);
-    drawLine(g, 50, lab, v3, sel == 2);
-
-    // Save
-    strncpy_P(lab, (sel == 3) ? L_SAVE_SEL : L_SAVE, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    drawLine(g, 62, lab, nullptr, sel == 3);
-  } while (g->nextPage());
+  if (!initialized) update(gfx);
+  const char* const values[4] = { pctText, invText, uniText, nullptr };
+  drawOptionRowsP_P((U8G2*)gfx, T_DISP_OPTS, DISP_LABELS, values, 4, sel);
 }
 
 void DisplayOptionsContext::handleInput(int input) {
@@ -91,6 +66,7 @@ void DisplayOptionsContext::handleInput(int input) {
     } else if (sel == 2) {
       // Unicorn easter egg: flip invert for fun
       invert = !invert;
+      refreshText();
     }
   } else if (input == KEY_BACK) {
     (void)goBack();
@@ -109,7 +85,7 @@ public:
     static const char MSG_ADJ[]      PROGMEM = "Use Up/Down to adjust";
     U8G2* g = (U8G2*)gfx;
     auto& s = settings_get();
-    char v[12]; snprintf(v, sizeof(v), "%u%%", (unsigned)s.bl_max_percent);
+    char v[12]; snprintf_P(v, sizeof(v), PSTR("%u%%"), (unsigned)s.bl_max_percent);
     g->firstPage();
     do {
       drawTitleWithLines_P(g, T_MAX_BRIGHT, 12, 6);
@@ -38,53 +38,42 @@ static uint8_t findPresetIndex(uint32_t rgb) {
 LedOptionsContext::LedOptionsContext()
   : ContextObject("LED_OPTIONS", "SETTINGS", nullptr, 0), sel(0), initialized(false), brightness(128), hitIndex(0), stepIndex(0) {}
 
+static const char T_LED_OPTS[]  PROGMEM = "LED Options";
+static const char L_BRIGHT[]    PROGMEM = "Brightness";
+static const char L_HIT[]       PROGMEM = "Hit Color";
+static const char L_STEP[]      PROGMEM = "Step Color";
+static const char L_SAVE[]      PROGMEM = "Save";
+static const char* const LED_LABELS[] PROGMEM = { L_BRIGHT, L_HIT, L_STEP, L_SAVE };
+
+static void copyPresetName(char* dst, uint8_t len, uint8_t idx) {
+  strncpy_P(dst, (const char*)pgm_read_ptr(&PRESETS[idx].nameP), len - 1);
+  dst[len - 1] = '\0';
+}
+
+void LedOptionsContext::refreshText() {
+  snprintf_P(pctText, sizeof(pctText), PSTR("%u%%"), (unsigned)((brightness * 100u) / 255u));
+  copyPresetName(hitText, sizeof(hitText), hitIndex);
+  copyPresetName(stepText, sizeof(stepText), stepIndex);
+}
+
 void LedOptionsContext::update(void* /*gfx*/) {
   // Always reflect latest settings so sub-screens edits show here.
   auto& s = settings_get();
-  brightness = s.ws_brightness;
-  hitIndex   = findPresetIndex(s.ws_hit_color);
-  stepIndex  = findPresetIndex(s.ws_step_color);
-  initialized = true;
-}
-
-static void drawLineR(U8G2* g, int y, const char* label, const char* value, bool sel) {
-  if (sel) { g->drawBox(0, y - 10, 128, 12); g->setDrawColor(0); }
-  g->drawStr(4, y, label);
-  if (value) {
-    int w = g->getDisplayWidth(); int tw = g->getUTF8Width(value);
-    g->drawStr(w - tw - 4, y, value);
+  const uint8_t hit  = findPresetIndex(s.ws_hit_color);
+  const uint8_t step = findPresetIndex(s.ws_step_color);
+  if (!initialized || brightness != s.ws_brightness || hitIndex != hit || stepIndex != step) {
+    brightness = s.ws_brightness;
+    hitIndex   = hit;
+    stepIndex  = step;
+    refreshText();
   }
-  if (sel) g->setDrawColor(1);
+  initialized = true;
 }
 
 void LedOptionsContext::draw(void* gfx) {
-  U8G2* g = (U8G2*)gfx;
-  static const char T_LED_OPTS[]  PROGMEM = "LED Options";
-  static const char L_BRIGHT[]    PROGMEM = "Brightness";
-  static const char L_HIT[]       PROGMEM = "Hit Color";
-  static const char L_STEP[]      PROGMEM = "Step Color";
-  static const char L_SAVE[]      PROGMEM = "Save";
-  static const char L_SAVE_SEL[]  PROGMEM = "> Save";
-
-  g->firstPage();
-  do {
-    drawTitleWithLines_P(g, T_LED_OPTS, 12, 6);
-    g->setFont(u8g2_font_6x10_tf);
-    char vb[8]; snprintf(vb, sizeof(vb), "%u%%", (unsigned)((brightness * 100u) / 255u));
-    char lab[18];
-    strncpy_P(lab, L_BRIGHT, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    drawLineR(g, 26, lab, vb, sel == 0);
-    strncpy_P(lab, L_HIT, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    const char* pHit = (const char*)pgm_read_ptr(&PRESETS[hitIndex].nameP);
-    char vhit[16]; strncpy_P(vhit, pHit, sizeof(vhit)-1); vhit[sizeof(vhit)-1] = '\0';
-    drawLineR(g, 38, lab, vhit, sel == 1);
-    strncpy_P(lab, L_STEP, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    const char* pStep = (const char*)pgm_read_ptr(&PRESETS[stepIndex].nameP);
-    char vstep[16]; strncpy_P(vstep, pStep, sizeof(vstep)-1); vstep[sizeof(vstep)-1] = '\0';
-    drawLineR(g, 50, lab, vstep, sel == 2);
-    strncpy_P(lab, (sel == 3) ? L_SAVE_SEL : L_SAVE, sizeof(lab)-1); lab[sizeof(lab)-1] = '\0';
-    drawLineR(g, 62, lab, nullptr, sel == 3);
-  } while (g->nextPage());
+  if (!initialized) update(gfx);
+  const char* const values[4] = { pctText, hitText, stepText, nullptr };
+  drawOptionRowsP_P((U8G2*)gfx, T_LED_OPTS, LED_LABELS, values, 4, sel);
 }
 
 void LedOptionsContext::handleInput(int input) {
@@ -127,7 +116,7 @@ public:
     U8G2* g = (U8G2*)gfx;
     auto& s = settings_get();
     uint8_t pct = (uint16_t)s.ws_brightness * 100u / 255u;
-    char v[16]; snprintf(v, sizeof(v), "%u (%u%%)", (unsigned)s.ws_brightness, (unsigned)pct);
+    char v[16]; snprintf_P(v, sizeof(v), PSTR("%u (%u%%)"), (unsigned)s.ws_brightness, (unsigned)pct);
     static const char T_LED_BRIGHT[] PROGMEM = "LED Brightness";
     static const char MSG_ADJ[]      PROGMEM = "Use Up/Down to adjust";
     g->firstPage();
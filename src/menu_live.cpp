@@ -7,26 +7,169 @@
 #include "context_registry.h"
 #include "context_state.h"
 #include "input_codes.h"
+#include "seq_clock.h"
+#include "sequencer_core.h"
 #include <U8g2lib.h>
 #include <avr/pgmspace.h>
+#include <string.h>
+
+static_assert(LiveModeContext::ROWS <= NUM_INSTR && LiveModeContext::COLS <= NUM_STEPS,
+              "grid rows are tracks, columns are steps");
 
 LiveModeContext::LiveModeContext()
   : ContextObject("LIVE_MODE", "MAIN_MENU", /*subs*/ nullptr, /*count*/ 0) {
   // clear grid
-  for (uint8_t r = 0; r < ROWS; ++r)
-    for (uint8_t c = 0; c < COLS; ++c)
-      steps[r][c] = false;
+  memset(steps, 0, sizeof(steps));
+  memset(seqCells, 0, sizeof(seqCells));
+}
+
+#if LIVE_GRID_BITMAP
+
+// The grid as a pure function of state: OR of cell body/frame, cursor
+// frame and playhead underline (same pixels the drawBox path produces).
+bool LiveModeContext::pixelAt(int px, int py) const {
+  const int gx = px - OFF_X, gy = py - OFF_Y;
+
+  // Cursor: 1 px frame around the cell
+  const int cx = cursorCol * PITCH - 1, cy = cursorRow * PITCH - 1;
+  const int ce = CELL + 1;
+  if (gx >= cx && gx <= cx + ce && gy >= cy && gy <= cy + ce &&
+      (gx == cx || gx == cx + ce || gy == cy || gy == cy + ce)) return true;
+
+  if (gx < 0 || gy < 0) return false;
+  const uint8_t c = gx / PITCH, lx = gx % PITCH;
+  const uint8_t r = gy / PITCH, ly = gy % PITCH;
+  if (c >= COLS || lx >= CELL) return false;
+
+  // Playhead: underline of row r-1 sits on the first line of row r
+  if (c == playhead && ly == 0 && r >= 1 && r <= ROWS) return true;
+
+  if (r >= ROWS || ly >= CELL) return false;
+  if (steps[r] & (1u << c)) return true;
+  return lx == 0 || lx == CELL - 1 || ly == 0 || ly == CELL - 1;
+}
+
+// Row y of the bitmap, byte 0 at BMP_X
+uint8_t* LiveModeContext::bmpRow(int y) {
+#if DISP_FULL_BUFFER
+  return frame + y * DISP_ROW_BYTES + BMP_X / 8;
+#else
+  return &bmp[(y - BMP_Y) * BMP_BYTES];
+#endif
+}
+
+void LiveModeContext::paintRect(int x0, int y0, int x1, int y1) {
+  if (x0 < BMP_X) x0 = BMP_X;
+  if (y0 < BMP_Y) y0 = BMP_Y;
+  if (x1 > BMP_X + BMP_W - 1) x1 = BMP_X + BMP_W - 1;
+  if (y1 > BMP_Y + BMP_H - 1) y1 = BMP_Y + BMP_H - 1;
+  for (int y = y0; y <= y1; ++y) {
+    uint8_t* line = bmpRow(y);
+    for (int x = x0; x <= x1; ++x) {
+      const uint8_t bx = (uint8_t)(x - BMP_X);
+      const uint8_t m = (uint8_t)(0x80 >> (bx & 7));
+      if (pixelAt(x, y)) line[bx >> 3] |= m; else line[bx >> 3] &= (uint8_t)~m;
+    }
+  }
+}
+
+// Cell body plus the margin its cursor frame can touch
+void LiveModeContext::paintCell(uint8_t r, uint8_t c) {
+  const int x = OFF_X + c * PITCH, y = OFF_Y + r * PITCH;
+  paintRect(x - 1, y - 1, x + CELL, y + CELL);
+}
+
+// Just the eight underline segments of one column
+void LiveModeContext::paintPlayhead(uint8_t col) {
+  const int x = OFF_X + col * PITCH;
+  for (uint8_t r = 0; r < ROWS; ++r) {
+    const int y = OFF_Y + r * PITCH + CELL + 1;
+    paintRect(x, y, x + CELL - 1, y);
+  }
+}
+
+// Bring the bitmap up to date with whatever changed since the last frame
+void LiveModeContext::syncBitmap() {
+  if (!bmpValid) {
+    paintRect(BMP_X, BMP_Y, BMP_X + BMP_W - 1, BMP_Y + BMP_H - 1);
+    memset(dirtyCells, 0, sizeof(dirtyCells));
+    bmpValid = true;
+  } else {
+    for (uint8_t r = 0; r < ROWS; ++r) {
+      if (!dirtyCells[r]) continue;
+      for (uint8_t c = 0; c < COLS; ++c) if (dirtyCells[r] & (1u << c)) paintCell(r, c);
+      dirtyCells[r] = 0;
+    }
+    if (cursorRow != shownCursorRow || cursorCol != shownCursorCol) {
+      paintCell(shownCursorRow, shownCursorCol);
+      paintCell(cursorRow, cursorCol);
+    }
+    if (playhead != shownPlayhead) {
+      paintPlayhead(shownPlayhead);
+      paintPlayhead(playhead);
+    }
+  }
+  shownCursorRow = cursorRow; shownCursorCol = cursorCol;
+  shownPlayhead  = playhead;
+}
+
+#if DISP_FULL_BUFFER
+
+void LiveModeContext::draw(void* gfx) {
+  U8G2* gfxU8 = static_cast<U8G2*>(gfx);
+  if (!gfxU8) return;
+
+  // Another frame went out since ours: the buffer holds someone else's
+  if (disp_frameCount() != frameNo) bmpValid = false;
+  if (!bmpValid) gfxU8->clearBuffer();
+  frame = gfxU8->getBufferPtr();
+  syncBitmap();
+  gfxU8->sendBuffer();
+  frameNo = disp_frameCount();
+}
+
+#else
+
+// Copy the rows of the bitmap that fall in the current page straight into
+// U8g2's buffer (ST7920 layout: horizontal bytes, MSB left, R0 rotation).
+void LiveModeContext::blit(void* gfx) const {
+  U8G2* g = static_cast<U8G2*>(gfx);
+  uint8_t* buf = g->getBufferPtr();
+  const uint8_t stride = g->getBufferTileWidth();          // bytes per pixel row
+  const int page0 = g->getBufferCurrTileRow() * 8;
+  const int page1 = page0 + g->getBufferTileHeight() * 8;  // exclusive
+  int y0 = BMP_Y, y1 = BMP_Y + BMP_H;
+  if (y0 < page0) y0 = page0;
+  if (y1 > page1) y1 = page1;
+  for (int y = y0; y < y1; ++y) {
+    memcpy(buf + (y - page0) * stride + BMP_X / 8, &bmp[(y - BMP_Y) * BMP_BYTES], BMP_BYTES);
+  }
+}
+
+void LiveModeContext::draw(void* gfx) {
+  U8G2* gfxU8 = static_cast<U8G2*>(gfx);
+  if (!gfxU8) return;
+
+  syncBitmap();
+  gfxU8->firstPage();
+  do {
+    blit(gfxU8);
+  } while (gfxU8->nextPage());
 }
 
+#endif // DISP_FULL_BUFFER
+
+#else
+
 void LiveModeContext::draw(void* gfx) {
   U8G2* gfxU8 = static_cast<U8G2*>(gfx);
   if (!gfxU8) return;
 
   // Simple proof-of-life: title + 8×8 grid
-  const uint8_t cell = 5;      // cell size in pixels
-  const uint8_t pad  = 1;      // spacing between cells
-  const uint8_t offX = 10;      // top-left X
-  const uint8_t offY = 2;     // top-left Y
+  const uint8_t cell = CELL;   // cell size in pixels
+  const uint8_t pad  = PITCH - CELL;   // spacing between cells
+  const uint8_t offX = OFF_X;  // top-left X
+  const uint8_t offY = OFF_Y;  // top-left Y
 
   gfxU8->firstPage();
   do {
@@ -35,7 +178,7 @@ void LiveModeContext::draw(void* gfx) {
       for (uint8_t c = 0; c < COLS; ++c) {
         uint8_t x = offX + c * (cell + pad);
         uint8_t y = offY + r * (cell + pad);
-        bool on = steps[r][c];
+        bool on = steps[r] & (1u << c);
         bool isCursor   = (r == cursorRow && c == cursorCol);
         bool isPlayhead = (c == playhead);
 
@@ -49,21 +192,49 @@ void LiveModeContext::draw(void* gfx) {
   } while (gfxU8->nextPage());
 }
 
+#endif // LIVE_GRID_BITMAP
+
 void LiveModeContext::toggleStep(uint8_t r, uint8_t c) {
-  if (r < ROWS && c < COLS) steps[r][c] = !steps[r][c];
+  if (r < ROWS && c < COLS) {
+    steps[r] ^= (uint8_t)(1u << c);
+    seqCells[r] |= (uint8_t)(1u << c);
+    flushEdits();
+#if LIVE_GRID_BITMAP
+    dirtyCells[r] |= (uint8_t)(1u << c);
+#endif
+    invalidate();
+  }
+}
+
+// Copy toggled cells into the sequencer's working copy and commit it.
+// While the previous commit is still waiting for its boundary the cells
+// stay marked and go out with the next one.
+void LiveModeContext::flushEdits() {
+  uint8_t any = 0;
+  for (uint8_t r = 0; r < ROWS; ++r) any |= seqCells[r];
+  if (!any) return;
+  SeqPattern* w = seq_edit();
+  if (!w) return;
+  for (uint8_t r = 0; r < ROWS; ++r) {
+    for (uint8_t c = 0; c < COLS; ++c)
+      if (seqCells[r] & (1u << c)) seq_setStep(*w, r, c, (steps[r] & (1u << c)) ? SEQ_STEP_DEFAULT : 0);
+    seqCells[r] = 0;
+  }
+  seq_commit(SEQ_EDIT_QUANT);
 }
 
 void LiveModeContext::nextColumn() {
   playhead = (uint8_t)((playhead + 1) % COLS);
+  invalidate();
 }
 
 void LiveModeContext::update(void* /*gfx*/) {
-  // super basic “clock” just to show playhead moving without timers
+  flushEdits();
+  // Playhead follows the Timer3 clock, independent of loop/draw speed
+  playing = clk_running();
   if (playing) {
-    if (++tick > 3000) {  // tune this or drive via real clock/ISR
-      tick = 0;
-      nextColumn();
-    }
+    const uint8_t col = (uint8_t)(clk_position() % COLS);
+    if (col != playhead) { playhead = col; invalidate(); }
   }
 }
 
@@ -91,9 +262,11 @@ void LiveModeContext::handleInput(int input) {
       break;
 
     case IN_PLAY:
+      clk_start();
       playing = true;
       break;
     case IN_STOP:
+      clk_stop();
       playing = false;
       break;
 
@@ -38,8 +38,7 @@ MainMenuContext::MainMenuContext()
 
 void MainMenuContext::draw(void* gfx) {
   U8G2* gfxU8 = (U8G2*)gfx;
-  char t[24]; strncpy_P(t, TITLE_MAIN, sizeof(t)-1); t[sizeof(t)-1] = '\0';
-  drawMenuPagedP(gfxU8, t, items, itemCount, selectedIndex, 4);
+  drawMenuPagedP_P(gfxU8, TITLE_MAIN, items, itemCount, selectedIndex, 4);
 }
 
 void MainMenuContext::handleInput(int input) {
@@ -33,8 +33,7 @@ PatternMenuContext::PatternMenuContext()
 
 void PatternMenuContext::draw(void* gfx) {
   U8G2* gfxU8 = (U8G2*)gfx;
-  char t[24]; strncpy_P(t, TITLE_PATTERN, sizeof(t)-1); t[sizeof(t)-1] = '\0';
-  drawMenuPagedP(gfxU8, t, items, itemCount, selectedIndex, 4);
+  drawMenuPagedP_P(gfxU8, TITLE_PATTERN, items, itemCount, selectedIndex, 4);
 }
 
 void PatternMenuContext::handleInput(int input) {
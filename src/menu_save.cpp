@@ -33,8 +33,7 @@ SaveMenuContext::SaveMenuContext()
 
 void SaveMenuContext::draw(void* gfx) {
   U8G2* gfxU8 = (U8G2*)gfx;
-  char t[24]; strncpy_P(t, TITLE_SAVE, sizeof(t)-1); t[sizeof(t)-1] = '\0';
-  drawMenuPagedP(gfxU8, t, items, itemCount, selectedIndex, 4);
+  drawMenuPagedP_P(gfxU8, TITLE_SAVE, items, itemCount, selectedIndex, 4);
 }
 
 void SaveMenuContext::handleInput(int input) {
@@ -37,8 +37,7 @@ SettingsMenuContext::SettingsMenuContext()
 
 void SettingsMenuContext::draw(void* gfx) {
   U8G2* gfxU8 = (U8G2*)gfx;
-  char t[24]; strncpy_P(t, TITLE_SETTINGS, sizeof(t)-1); t[sizeof(t)-1] = '\0';
-  drawMenuPagedP(gfxU8, t, items, itemCount, selectedIndex, 4);
+  drawMenuPagedP_P(gfxU8, TITLE_SETTINGS, items, itemCount, selectedIndex, 4);
 }
 
 void SettingsMenuContext::handleInput(int input) {
@@ -0,0 +1,115 @@
+// profiler.cpp
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "profiler.h"
+
+#if PROF_ENABLED
+
+#include "context_registry.h"
+#include "debug.h"
+
+static ProfStat s_stage[PROF_STAGE_COUNT];
+static ProfStat s_ctx[PROF_CTX_SLOTS];
+static uint8_t  s_ctxOf[PROF_CTX_SLOTS];   // registry index + 1, 0 = free
+
+static const char PN_BUTTONS[]   PROGMEM = "buttons";
+static const char PN_BACKLIGHT[] PROGMEM = "backlt";
+static const char PN_ROUTE[]     PROGMEM = "route";
+static const char PN_UPDATE[]    PROGMEM = "update";
+static const char PN_DRAW[]      PROGMEM = "draw";
+static const char PN_LOOP[]      PROGMEM = "loop";
+static const char* const STAGE_NAMES[PROF_STAGE_COUNT] PROGMEM = {
+  PN_BUTTONS, PN_BACKLIGHT, PN_ROUTE, PN_UPDATE, PN_DRAW, PN_LOOP
+};
+
+static inline uint8_t histBin(uint32_t us) {
+  uint8_t bin = 0;
+  us >>= 5;                         // < 32 us → bin 0
+  while (us && bin < PROF_HIST_BINS - 1) { us >>= 2; bin++; }
+  return bin;
+}
+
+void prof_statAdd(ProfStat& s, uint32_t us) {
+  const uint16_t v = (us > 0xFFFF) ? 0xFFFF : (uint16_t)us;
+  if (!s.count || v < s.minUs) s.minUs = v;
+  if (v > s.maxUs) s.maxUs = v;
+
+  // Keep a running average without overflow: halve history when full
+  if (s.count == 0xFFFF) { s.count >>= 1; s.sumUs >>= 1; }
+  s.count++;
+  s.sumUs += v;
+
+  const uint8_t b = histBin(us);
+  if (s.hist[b] == 0xFF) {
+    for (uint8_t i = 0; i < PROF_HIST_BINS; ++i) s.hist[i] >>= 1;
+  }
+  s.hist[b]++;
+}
+
+void prof_record(uint8_t stage, uint32_t us) {
+  if (stage < PROF_STAGE_COUNT) prof_statAdd(s_stage[stage], us);
+}
+
+// Row of a registry index, claiming a free one if add; -1 if none
+static int8_t ctxSlot(uint8_t registryIndex, bool add) {
+  for (uint8_t i = 0; i < PROF_CTX_SLOTS; ++i) {
+    if (s_ctxOf[i] == registryIndex + 1) return (int8_t)i;
+    if (!s_ctxOf[i]) {
+      if (!add) return -1;
+      s_ctxOf[i] = registryIndex + 1;
+      return (int8_t)i;
+    }
+  }
+  return -1;
+}
+
+void prof_recordContext(const ContextObject* ctx, uint32_t us) {
+  const int8_t r = getContextIndex(ctx);
+  const int8_t i = (r >= 0) ? ctxSlot((uint8_t)r, true) : -1;
+  if (i >= 0) prof_statAdd(s_ctx[i], us);
+}
+
+void prof_reset() {
+  memset(s_stage, 0, sizeof(s_stage));
+  memset(s_ctx,   0, sizeof(s_ctx));
+  memset(s_ctxOf, 0, sizeof(s_ctxOf));
+}
+
+const ProfStat* prof_stage(uint8_t stage) {
+  return (stage < PROF_STAGE_COUNT) ? &s_stage[stage] : nullptr;
+}
+
+const ProfStat* prof_context(uint8_t registryIndex) {
+  const int8_t i = ctxSlot(registryIndex, false);
+  return (i >= 0 && s_ctx[i].count) ? &s_ctx[i] : nullptr;
+}
+
+const char* prof_stageName(uint8_t stage) {
+  return (stage < PROF_STAGE_COUNT) ? (const char*)pgm_read_ptr(&STAGE_NAMES[stage]) : nullptr;
+}
+
+void prof_dumpRow(const char* name, const ProfStat& s) {
+  char line[48];
+  const uint16_t avg = s.count ? (uint16_t)(s.sumUs / s.count) : 0;
+  snprintf_P(line, sizeof(line), PSTR("%-12s%6u%6u%6u%6u  "),
+           name, (unsigned)s.count, (unsigned)s.minUs,
+           (unsigned)avg, (unsigned)s.maxUs);
+  DPRINT(line);
+  for (uint8_t i = 0; i < PROF_HIST_BINS; ++i) { DPRINT((unsigned)s.hist[i]); DL(" "); }
+  DPRINTLN("");
+}
+
+void prof_dump() {
+  DLLN("-- profile (us) --  name n min avg max | " PROF_HIST_LEGEND);
+  char name[16];
+  for (uint8_t i = 0; i < PROF_STAGE_COUNT; ++i) {
+    strncpy_P(name, prof_stageName(i), sizeof(name) - 1); name[sizeof(name) - 1] = '\0';
+    prof_dumpRow(name, s_stage[i]);
+  }
+  for (uint8_t i = 0; i < PROF_CTX_SLOTS && s_ctxOf[i]; ++i) {
+    ContextObject* ctx = getContextByIndex((uint8_t)(s_ctxOf[i] - 1));
+    prof_dumpRow(ctx ? ctx->name : "?", s_ctx[i]);
+  }
+}
+
+#endif // PROF_ENABLED
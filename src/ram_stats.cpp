@@ -0,0 +1,47 @@
+// ram_stats.cpp
+#include <Arduino.h>
+#include <avr/io.h>
+#include "ram_stats.h"
+#include "debug.h"
+
+#define RAM_PAINT_BYTE 0xA5
+
+extern uint8_t __heap_start;   // end of .bss (linker)
+extern void*   __brkval;       // malloc's break, 0 until the first malloc
+
+static inline uint8_t* stackPtr() { return (uint8_t*)(uintptr_t)SP; }
+
+static inline uint8_t* heapEnd() {
+  return __brkval ? (uint8_t*)__brkval : &__heap_start;
+}
+
+void ram_paint() {
+  uint8_t* p = heapEnd();
+  uint8_t* const top = stackPtr() - RAM_PAINT_GUARD;
+  while (p < top) *p++ = RAM_PAINT_BYTE;
+}
+
+uint16_t ram_static() { return (uint16_t)(&__heap_start - (uint8_t*)(uintptr_t)RAMSTART); }
+
+uint16_t ram_free() {
+  const uint8_t* sp = stackPtr();
+  const uint8_t* he = heapEnd();
+  return (sp > he) ? (uint16_t)(sp - he) : 0;
+}
+
+uint16_t ram_minFree() {
+  const uint8_t* p  = heapEnd();
+  const uint8_t* sp = stackPtr();
+  uint16_t n = 0;
+  while (p < sp && *p == RAM_PAINT_BYTE) { ++p; ++n; }
+  return n;
+}
+
+void ram_dump() {
+#if DEBUG_SERIAL
+  DL("ram: static "); DPRINT(ram_static());
+  DL(" free ");       DPRINT(ram_free());
+  DL(" min ");        DPRINT(ram_minFree());
+  DL(" of ");         DPRINTLN((uint16_t)(RAMEND - RAMSTART + 1));
+#endif
+}
@@ -0,0 +1,41 @@
+// render_gate.cpp
+#include <Arduino.h>
+#include "render_gate.h"
+#include "object_classes.h"
+#include "context_state.h"
+#include "debug.h"
+
+static uint32_t s_drawn   = 0;
+static uint32_t s_skipped = 0;
+static unsigned long s_lastFrameMs = 0;
+
+void render_invalidate() {
+  if (ContextObject* ctx = currentContext()) ctx->invalidate();
+}
+
+bool render_frame_due(ContextObject* ctx) {
+  if (!ctx || !ctx->dirty) { s_skipped++; return false; }
+
+  const unsigned long now = millis();
+  if ((now - s_lastFrameMs) < RENDER_MIN_FRAME_MS) { s_skipped++; return false; }
+
+  // Clear before drawing so invalidations raised during draw() are kept.
+  s_lastFrameMs = now;
+  ctx->dirty = false;
+  s_drawn++;
+  return true;
+}
+
+uint32_t render_frames_drawn()   { return s_drawn; }
+uint32_t render_frames_skipped() { return s_skipped; }
+
+void render_stats_poll() {
+#if DEBUG_SERIAL
+  static unsigned long lastReport = 0;
+  const unsigned long now = millis();
+  if ((now - lastReport) < RENDER_STATS_MS) return;
+  lastReport = now;
+  DL("frames drawn="); DPRINT(s_drawn);
+  DL(" skipped=");     DPRINTLN(s_skipped);
+#endif
+}
@@ -0,0 +1,220 @@
+// seq_clock.cpp
+#include <Arduino.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "seq_clock.h"
+#include "sequencer_core.h"
+#include "event_bus.h"
+#include "timebase.h"
+#include "LoopManager.h"
+
+// Timer3 runs at F_CPU/64 = 250 kHz (4 us per count).
+// Tick period in counts = 250000 * 60 / (bpm * ppqn). We keep it in Q8
+// (24.8 fixed point) and carry the fractional part from tick to tick, so
+// the long-term tempo is exact even though OCR3A only holds whole counts.
+static const uint32_t TIMER_HZ = F_CPU / 64UL;
+static const uint32_t PERIOD_Q8_NUM = TIMER_HZ * 60UL * 256UL / SEQ_CLOCK_PPQN;
+
+static uint16_t s_bpm = SEQ_BPM_DEFAULT;
+static volatile uint16_t s_periodWhole;   // counts per tick (integer part)
+static volatile uint8_t  s_periodFrac;    // counts per tick (1/256ths)
+static volatile uint8_t  s_fracAcc = 0;   // running fractional remainder
+static volatile uint32_t s_ticks   = 0;   // ticks since start
+static volatile uint8_t  s_sub     = 0;   // tick within current step
+static volatile bool     s_running = false;
+static int8_t            s_tickTask = -1;     // loop task woken per tick
+
+// External follow state
+static volatile bool     s_follow       = false;  // slaved to ext edges
+static volatile uint8_t  s_ticksPerEdge = 1;
+static volatile uint8_t  s_edgeSub      = 0;      // ticks emitted since last edge
+static volatile uint8_t  s_hold         = 0;      // matches spent waiting for a late edge
+static volatile uint32_t s_edgeAt       = 0;      // timebase stamp of the last edge
+static volatile uint32_t s_edgePeriod   = 0;      // edge period it carried (timebase ticks)
+
+// Timer3 count = 4 us; timebase tick = 1/TB_TICKS_PER_US us
+static const uint8_t TB_TO_Q8 = 256 / (4 * TB_TICKS_PER_US);
+
+static void computePeriod(uint16_t bpm) {
+  const uint32_t q8 = PERIOD_Q8_NUM / bpm;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    s_periodWhole = (uint16_t)(q8 >> 8);
+    s_periodFrac  = (uint8_t)q8;
+  }
+}
+
+// Runs in ISR context; producer = the ISR we're called from
+static void pushSync(uint8_t producer, uint8_t locked) {
+  Event e;
+  e.type = EVT_CLOCK_SYNC;
+  e.src  = SRC_CLOCK;
+  e.a    = locked;     // 1 = following external clock, 0 = internal tempo
+  e.b    = 0;
+  eb_pushFrom(producer, e);
+}
+
+// Runs in ISR context; producer = the ISR we're called from
+static inline void emitTick(uint8_t producer) {
+  // Engine: gate-offs every tick, advance + triggers on step boundaries
+  seq_tick(s_sub);
+
+#if SEQ_CLOCK_PPQN == 96
+  const bool on24 = ((uint8_t)s_ticks & 3) == 0;
+  const uint8_t t24 = (uint8_t)((s_ticks >> 2) % 24);
+#else
+  const bool on24 = true;
+  const uint8_t t24 = (uint8_t)(s_ticks % 24);
+#endif
+  if (on24) {
+    Event e;
+    e.type = EVT_TICK_24PPQN;
+    e.src  = SRC_CLOCK;
+    e.a    = t24;      // pulse within the quarter note
+    e.b    = seq_pattern().pos;    // current step
+    eb_pushFrom(producer, e);
+    triggerLoopTask(s_tickTask);
+  }
+
+  s_ticks++;
+  if (++s_sub >= SEQ_TICKS_PER_STEP) s_sub = 0;
+}
+
+ISR(TIMER3_COMPA_vect) {
+  // Program the next period first: whole counts plus carry from the
+  // fractional accumulator. In CTC mode the counter has just wrapped,
+  // so the new OCR3A is always ahead of TCNT3.
+  const uint16_t acc = (uint16_t)s_fracAcc + s_periodFrac;
+  s_fracAcc = (uint8_t)acc;
+  OCR3A = (uint16_t)(s_periodWhole + (acc >> 8) - 1);
+
+  if (!s_follow) { emitTick(PROD_CLOCK_ISR); return; }
+
+  // Slaved: spread the remaining sub-ticks of this edge period
+  if (s_edgeSub < s_ticksPerEdge) { emitTick(PROD_CLOCK_ISR); s_edgeSub++; return; }
+
+  // Group complete and the edge is late: hold; after two edge periods
+  // without an edge, give up and run on the internal tempo again.
+  if (++s_hold >= (uint8_t)(2 * s_ticksPerEdge)) {
+    s_follow = false;
+    computePeriod(s_bpm);
+    pushSync(PROD_CLOCK_ISR, 0);
+  }
+}
+
+void clk_extEdgeFromISR(uint32_t edgePeriodTb, uint8_t ticksPerEdge) {
+  if (!ticksPerEdge) return;
+  const uint32_t q8 = (edgePeriodTb * TB_TO_Q8) / ticksPerEdge;
+  if ((q8 >> 8) < 2 || (q8 >> 8) > 0xFFFF) return;   // out of Timer3 range
+  s_periodWhole  = (uint16_t)(q8 >> 8);
+  s_periodFrac   = (uint8_t)q8;
+  s_ticksPerEdge = ticksPerEdge;
+  s_hold         = 0;
+  s_edgeAt       = tb_nowISR();
+  s_edgePeriod   = edgePeriodTb;
+  if (!s_follow) {
+    s_follow  = true;
+    s_edgeSub = ticksPerEdge;   // fresh lock: nothing owed from before
+    pushSync(PROD_EXTCLK_ISR, 1);
+  }
+  if (!s_running) return;
+
+  // Incoming clock ran faster than our estimate: flush what we still owe
+  while (s_edgeSub < s_ticksPerEdge) { emitTick(PROD_EXTCLK_ISR); s_edgeSub++; }
+
+  // Realign sub-tick phase to this edge, then play the on-edge tick
+  TCNT3     = 0;
+  s_fracAcc = 0;
+  OCR3A     = (uint16_t)(s_periodWhole - 1);
+  TIFR3     = _BV(OCF3A);
+  emitTick(PROD_EXTCLK_ISR);
+  s_edgeSub = 1;
+}
+
+bool clk_following() { return s_follow; }
+
+void clk_poll() {
+  if (!s_follow) return;
+  uint32_t at, period;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { at = s_edgeAt; period = s_edgePeriod; }
+  // One period for the edge that's due plus the two the Timer3 ISR holds
+  // for, so a running transport normally drops the lock there first
+  if (tb_now() - at <= 3 * period) return;
+  bool lost = false;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    // Period reload in the same block: an edge slipping in after the
+    // unlock would relock and then lose its period to the internal one
+    if (s_follow && s_edgeAt == at) { s_follow = false; computePeriod(s_bpm); lost = true; }
+  }
+  if (lost) pushSync(PROD_MAIN, 0);
+}
+
+void clk_setTickTask(int8_t taskId) { s_tickTask = taskId; }
+
+void clk_init() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR3A = 0;                 // no output compare pins, CTC via WGM32
+    TCCR3B = _BV(WGM32);        // CTC (TOP = OCR3A), clock stopped
+    TCNT3  = 0;
+    TIMSK3 = 0;
+    TIFR3  = _BV(OCF3A);        // clear stale match flag
+  }
+  computePeriod(s_bpm);
+}
+
+void clk_set_bpm(uint16_t bpm) {
+  if (bpm < SEQ_BPM_MIN) bpm = SEQ_BPM_MIN;
+  if (bpm > SEQ_BPM_MAX) bpm = SEQ_BPM_MAX;
+  s_bpm = bpm;
+  computePeriod(bpm);
+}
+
+uint16_t clk_get_bpm() { return s_bpm; }
+
+void clk_start() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    seq_reset();
+    s_ticks   = 0;
+    s_sub     = 0;
+    s_fracAcc = 0;
+    TCNT3  = 0;
+    if (s_follow) {
+      // Slaved: wait for the next edge to play step 0
+      s_edgeSub = s_ticksPerEdge;
+      s_hold    = 0;
+      OCR3A     = (uint16_t)(s_periodWhole - 1);
+    } else {
+      // First compare two counts (8 us) out → step 0 plays now. Not 0:
+      // the TCNT3 write above blocks a match on the next timer clock, so
+      // OCR3A = 0 would only match after a full 65536-count wrap.
+      OCR3A  = 1;
+    }
+    TIFR3  = _BV(OCF3A);
+    TIMSK3 = _BV(OCIE3A);
+    TCCR3B = _BV(WGM32) | _BV(CS31) | _BV(CS30);   // clk/64
+    s_running = true;
+  }
+}
+
+void clk_stop() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR3B = _BV(WGM32);        // stop clock, keep mode
+    TIMSK3 = 0;
+    s_running = false;
+    seq_allOff();               // don't leave gates hanging
+    seq_landSwap();             // no boundary is coming for a pending edit
+  }
+}
+
+bool clk_running() { return s_running; }
+
+uint32_t clk_ticks() {
+  uint32_t t;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { t = s_ticks; }
+  return t;
+}
+
+uint8_t clk_position() {
+  // single byte written by the ISR; volatile read is enough
+  return *(const volatile uint8_t*)&seq_pattern().pos;
+}
@@ -1,7 +1,577 @@
-// core.cpp
+// sequencer_core.cpp
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include <util/atomic.h>
 #include "sequencer_core.h"
-void seq_reset(Pattern& p){ p.pos=0; }
-void seq_tick(Pattern& p){
-p.pos = (p.pos + 1) % p.length;
-// In real-time code we’d emit events per unmuted Track here
-}
\ No newline at end of file
+#include "seq_clock.h"
+#include "timebase.h"
+#include "timing_wheel.h"
+#include "debug.h"
+
+// Play/edit buffers. s_play is the only thing the ISR reads to pick one;
+// s_swapReq (loop sets, ISR clears) hands the edit buffer over.
+static SeqPattern g_buf[2];
+static volatile uint8_t s_play = 0;
+static volatile uint8_t s_swapReq = 0;
+static uint8_t s_quant = SEQ_QUANT_BAR;   // of the pending swap
+static bool s_stale = false;              // edit buffer predates the last swap
+const SeqPattern& seq_pattern(){ return g_buf[s_play]; }
+
+// Step period in clock ticks per SeqRate (at least 2, so there is room
+// to resolve a step one tick ahead)
+#define RP(num, den) (((SEQ_TICKS_PER_STEP * (num)) / (den)) > 2 ? ((SEQ_TICKS_PER_STEP * (num)) / (den)) : 2)
+static const uint8_t RATE_PERIOD[SEQ_RATE_COUNT] = {
+  RP(1, 1), RP(1, 2), RP(1, 3), RP(1, 4), RP(2, 3), RP(4, 3), RP(2, 1), RP(3, 1), RP(4, 1), RP(8, 1)
+};
+#undef RP
+static_assert(SEQ_TICKS_PER_STEP * 8 <= 255, "RATE_PERIOD holds bytes");
+
+// A step fires when rnd8() < threshold; SEQ_PROB_100 skips the draw
+static const uint8_t PROB_THRESH[4] = { 255, 192, 128, 64 };
+
+static SeqOutFn s_out = nullptr;
+static volatile uint16_t s_open = 0;      // open gates, bit = track (ISR writes)
+static uint8_t s_gen[NUM_INSTR];          // last note resolved per track
+static uint8_t s_gateGen[NUM_INSTR];      // note each open gate belongs to
+static bool    s_fresh = true;            // next tick starts every track
+static uint16_t s_rng = 0xACE1;
+
+// Per-track playback (ISR only). The step at next is resolved once left
+// reaches lead and starts playing when left runs out.
+#define RUN_BACK 0x01   // ping-pong heading down
+#define RUN_ODD  0x02   // next is an off-beat (gets swing)
+struct TrackRun {
+  uint8_t pos, next;    // step playing / step coming up
+  uint8_t left;         // ticks to the next boundary
+  uint8_t period, lead; // of the current step
+  uint8_t flags;
+};
+static TrackRun s_run[NUM_INSTR];
+
+// Groove: written by the loop, read as bytes by the ISR
+static uint8_t s_swing = SEQ_SWING_MIN;
+static uint8_t s_trackSwing[NUM_INSTR];   // 0 = follow s_swing
+static uint8_t s_swingQ8[NUM_INSTR];      // off-beat delay, 1/256 of the track's step
+
+static_assert(SEQ_LEAD_TICKS + SEQ_NUDGE_MAX + SEQ_TICKS_PER_STEP / 2 + SEQ_TICKS_PER_STEP < SEQ_WHEEL_SLOTS,
+              "the wheel must reach lead + nudge + swing + a whole-step gate at X1");
+
+#if SEQ_STATS
+static ProfStat s_tickCost;
+static uint16_t s_overruns = 0;
+#endif
+
+// xorshift16; one call per probabilistic step
+static inline uint8_t rnd8() {
+  uint16_t x = s_rng;
+  x ^= x << 7;
+  x ^= x >> 9;
+  x ^= x << 8;
+  s_rng = x;
+  return (uint8_t)x;
+}
+
+static inline void out(uint8_t track, uint8_t vel) {
+  if (s_out) s_out(track, vel);
+}
+
+void seq_setOutput(SeqOutFn fn) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { s_out = fn; }
+}
+
+uint8_t seq_trackPos(uint8_t track) {
+  return (track < NUM_INSTR) ? s_run[track].pos : 0;   // byte written by the ISR
+}
+
+uint16_t seq_gates() {
+  uint16_t g;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { g = s_open; }
+  return g;
+}
+
+// Wheel job due: open a gate (closing a still-open one first) or close
+// it, unless a newer note on the track has taken the gate over since
+static void fire(uint8_t t, uint8_t vel, uint8_t gen) {
+  const uint16_t bit = (uint16_t)1 << t;
+  if (vel) {
+    if (s_open & bit) out(t, 0);                         // retrigger: close first
+    s_open |= bit;
+    s_gateGen[t] = gen;
+    out(t, vel);
+  } else if ((s_open & bit) && s_gateGen[t] == gen) {
+    s_open &= (uint16_t)~bit;
+    out(t, 0);
+  }
+}
+
+// ---- Layout access ----
+// Step byte of a track known to trigger at pos
+static inline uint8_t hitByte(const Pattern& p, uint8_t t, uint8_t pos) { return p.trk[t].steps[pos]; }
+static inline uint8_t hitByte(const PackedPattern& p, uint8_t t, uint8_t pos) {
+  const uint8_t v = p.voice[t];
+  if (!(p.accent[pos] & ((uint16_t)1 << t))) return v;
+  return (uint8_t)((v & (uint8_t)~SEQ_STEP_VEL_MASK) | (SEQ_ACCENT_LEVEL << SEQ_STEP_VEL_SHIFT));
+}
+
+static inline int8_t nudgeOf(const Pattern& p, uint8_t t, uint8_t pos)       { return p.trk[t].nudge[pos]; }
+static inline int8_t nudgeOf(const PackedPattern& p, uint8_t, uint8_t pos)   { return p.nudge[pos]; }
+
+// Track t plays something at pos (unmuted, not a rest)
+static inline uint8_t hasHit(const Pattern& p, uint8_t t, uint8_t pos) {
+  return (p.trk[t].steps[pos] & SEQ_STEP_VEL_MASK) && !p.trk[t].mute;
+}
+static inline uint8_t hasHit(const PackedPattern& p, uint8_t t, uint8_t pos) {
+  return (uint8_t)(((p.trig[pos] & (uint16_t)~p.mute) >> t) & 1);
+}
+
+// hasHit() for every track at once, bit = track. One word read in the
+// bitplane layout, a pass over the tracks in the byte layout.
+static inline uint16_t triggers(const Pattern& p, uint8_t pos) {
+  uint16_t m = 0;
+  for (uint8_t t = NUM_INSTR; t-- > 0;) {
+    m <<= 1;
+    if ((p.trk[t].steps[pos] & SEQ_STEP_VEL_MASK) && !p.trk[t].mute) m |= 1;
+  }
+  return m;
+}
+static inline uint16_t triggers(const PackedPattern& p, uint8_t pos) {
+  return p.trig[pos] & (uint16_t)~p.mute;
+}
+
+static inline SeqTrackCfg cfgOf(const Pattern& p, uint8_t t) {
+  const Track& k = p.trk[t];
+  return SeqTrackCfg{ k.length, k.rate, k.dir };
+}
+static inline SeqTrackCfg cfgOf(const PackedPattern& p, uint8_t t) {
+  const uint8_t m = p.trkMode[t];
+  return SeqTrackCfg{ p.trkLength[t], (uint8_t)(m & 0x0F), (uint8_t)(m >> 4) };
+}
+
+// Loop length of a track: its own, else the pattern's (clamped, never 0)
+template <class P>
+static inline uint8_t lengthOf(const P& p, const SeqTrackCfg& c) {
+  uint8_t len = c.length ? c.length : p.length;
+  if (len > NUM_STEPS) len = NUM_STEPS;
+  return len ? len : 1;
+}
+
+// Out-of-range rate/dir → 0 (SEQ_RATE_X1 / SEQ_DIR_FWD)
+static inline uint8_t inRange(uint8_t v, uint8_t count) { return v < count ? v : 0; }
+
+static inline uint8_t periodOf(const SeqTrackCfg& c) {
+  return RATE_PERIOD[inRange(c.rate, SEQ_RATE_COUNT)];
+}
+
+// Resolve a step half the period ahead (up to SEQ_LEAD_TICKS)
+static inline uint8_t leadOf(uint8_t period) {
+  const uint8_t half = period >> 1;
+  return half < SEQ_LEAD_TICKS ? half : SEQ_LEAD_TICKS;
+}
+
+// Where a track goes after pos; compare-and-wrap only
+static inline uint8_t stepAfter(TrackRun& r, uint8_t pos, uint8_t len, uint8_t dir) {
+  if (pos >= len) pos = (uint8_t)(len - 1);              // loop got shorter
+  switch (dir) {
+    case SEQ_DIR_REV:
+      return pos ? (uint8_t)(pos - 1) : (uint8_t)(len - 1);
+    case SEQ_DIR_PINGPONG:
+      if (len == 1) return 0;
+      if (r.flags & RUN_BACK) {
+        if (pos) return (uint8_t)(pos - 1);
+        r.flags &= (uint8_t)~RUN_BACK;
+        return 1;
+      }
+      if ((uint8_t)(pos + 1) < len) return (uint8_t)(pos + 1);
+      r.flags |= RUN_BACK;
+      return (uint8_t)(pos - 1);
+    case SEQ_DIR_RANDOM:
+      return (uint8_t)(((uint16_t)rnd8() * len) >> 8);
+    default:
+      return ((uint8_t)(pos + 1) < len) ? (uint8_t)(pos + 1) : 0;
+  }
+}
+
+static inline uint8_t firstStep(uint8_t len, uint8_t dir) {
+  switch (dir) {
+    case SEQ_DIR_REV:    return (uint8_t)(len - 1);
+    case SEQ_DIR_RANDOM: return (uint8_t)(((uint16_t)rnd8() * len) >> 8);
+    default:             return 0;
+  }
+}
+
+// Schedule track t's step pos, known to trigger, whose boundary is lead
+// ticks away
+template <class P>
+static inline void resolveHit(const P& p, uint8_t t, uint8_t pos, uint8_t lead, uint8_t period, bool offBeat) {
+  const uint8_t s = hitByte(p, t, pos);
+  const uint8_t prob = s & SEQ_STEP_PROB_MASK;
+  if (prob != SEQ_PROB_100 && rnd8() >= PROB_THRESH[prob]) return;
+  int16_t at = (int16_t)lead + nudgeOf(p, t, pos);
+  if (offBeat) at += (int16_t)(((uint16_t)period * s_swingQ8[t] + 128) >> 8);
+  if (at < 0) at = 0;                                    // no lead on the first step
+  if (at > SEQ_WHEEL_SLOTS - 2) at = SEQ_WHEEL_SLOTS - 2;
+  uint16_t gate = ((uint16_t)period * (uint8_t)(((s & SEQ_STEP_GATE_MASK) >> SEQ_STEP_GATE_SHIFT) + 1)) >> 2;
+  if (!gate) gate = 1;
+  if (at + gate > SEQ_WHEEL_SLOTS - 1) gate = (uint16_t)(SEQ_WHEEL_SLOTS - 1 - at);   // slow tracks
+  const uint8_t gen = ++s_gen[t];
+  wheel_schedule((uint8_t)at, t, (uint8_t)(((s & SEQ_STEP_VEL_MASK) >> 1) | 0x07), gen);
+  wheel_schedule((uint8_t)(at + gate), t, 0, gen);
+}
+
+template <class P>
+static inline void resolveTrack(const P& p, uint8_t t, uint8_t pos, uint8_t lead, uint8_t period, bool offBeat) {
+  if (hasHit(p, t, pos)) resolveHit(p, t, pos, lead, period, offBeat);
+}
+
+// Enter the step at r.next: reload the countdown from the track's
+// current config and work out the step after it
+template <class P>
+static inline void enterStep(const P& p, uint8_t t, TrackRun& r) {
+  const SeqTrackCfg c = cfgOf(p, t);
+  r.pos    = r.next;
+  r.period = periodOf(c);
+  r.lead   = leadOf(r.period);
+  r.left   = r.period;
+  r.flags ^= RUN_ODD;
+  r.next   = stepAfter(r, r.pos, lengthOf(p, c), c.dir);
+}
+
+template <class P>
+static inline void startTracks(P& p) {
+  p.pos = 0;
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    TrackRun& r = s_run[t];
+    const SeqTrackCfg c = cfgOf(p, t);
+    r.flags = 0;                                         // first step is on the beat
+    r.next  = firstStep(lengthOf(p, c), c.dir);
+    enterStep(p, t, r);
+    resolveTrack(p, t, r.pos, 0, r.period, false);
+  }
+}
+
+template <class P>
+static inline void resetT(P& p) {
+  p.pos = 0;
+  s_fresh = true;
+  seq_allOff();
+}
+
+// Bar position on the 16th grid, then every track's countdown: resolve
+// the coming step at its lead, enter it when the countdown runs out.
+// Tracks whose coming step is the grid's next one (the plain X1/forward
+// case) test one trigger word for that step, read the first time one of
+// them needs it; the others test their own step. Finally run whatever the
+// wheel has due on this tick.
+template <class P>
+static inline void tickT(P& p, uint8_t sub) {
+  if (s_fresh) {
+    s_fresh = false;
+    startTracks(p);
+  } else {
+    if (sub == 0 && ++p.pos >= p.length) p.pos = 0;
+    const uint8_t gridNext = ((uint8_t)(p.pos + 1) < p.length) ? (uint8_t)(p.pos + 1) : 0;
+    uint16_t hits = 0;
+    bool haveHits = false;
+    for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+      TrackRun& r = s_run[t];
+      if (--r.left == 0) enterStep(p, t, r);
+      if (r.left != r.lead) continue;
+      if (r.next != gridNext) {
+        resolveTrack(p, t, r.next, r.lead, r.period, r.flags & RUN_ODD);
+        continue;
+      }
+      if (!haveHits) { hits = triggers(p, gridNext); haveHits = true; }
+      if (hits & ((uint16_t)1 << t)) resolveHit(p, t, r.next, r.lead, r.period, r.flags & RUN_ODD);
+    }
+  }
+  wheel_tick(fire);
+}
+
+#if SEQ_STATS
+#define SEQ_TIMED(stmt) do { \
+    const uint32_t _t0 = tb_nowISR(); stmt; \
+    const uint32_t _us = tb_to_us(tb_nowISR() - _t0); \
+    prof_statAdd(s_tickCost, _us); \
+    if (_us > SEQ_TICK_BUDGET_US && s_overruns != 0xFFFF) s_overruns++; \
+  } while (0)
+#else
+#define SEQ_TIMED(stmt) do { stmt; } while (0)
+#endif
+
+// Play the edit buffer from here on; the bar position carries over
+static inline void takeEdit() {
+  g_buf[s_play ^ 1].pos = g_buf[s_play].pos;
+  s_play ^= 1;
+  s_swapReq = 0;
+}
+
+// Take the edit buffer if a swap is due: on the first tick, or at the
+// lead point before a step/beat/bar boundary. Tracks keep their own
+// positions.
+static inline void swapDue(uint8_t sub) {
+  if (!s_swapReq) return;
+  const SeqPattern& cur = g_buf[s_play];
+  if (!s_fresh) {
+    if (sub != SEQ_TICKS_PER_STEP - SEQ_LEAD_TICKS) return;
+    const uint8_t next = ((uint8_t)(cur.pos + 1) < cur.length) ? (uint8_t)(cur.pos + 1) : 0;
+    if (s_quant == SEQ_QUANT_BEAT && (next & 3)) return;
+    if (s_quant == SEQ_QUANT_BAR && next) return;
+  }
+  takeEdit();
+}
+
+void seq_reset()          { resetT(g_buf[s_play]); }
+void seq_tick(uint8_t sub) { SEQ_TIMED(swapDue(sub); tickT(g_buf[s_play], sub)); }
+
+SeqPattern* seq_edit() {
+  if (s_swapReq) return nullptr;
+  SeqPattern& w = g_buf[s_play ^ 1];
+  if (s_stale) {
+    w = g_buf[s_play];            // the ISR only writes pos, a byte
+    s_stale = false;
+  }
+  return &w;
+}
+
+void seq_commit(uint8_t quant) {
+  if (s_swapReq) return;
+  s_stale = true;
+  if (!clk_running()) {
+    // No ISR to wait for; clk_start() runs from the loop too
+    takeEdit();
+    return;
+  }
+  s_quant = quant;
+  s_swapReq = 1;                  // publish last
+}
+
+bool seq_swapPending() { return s_swapReq; }
+
+void seq_landSwap() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { if (s_swapReq) takeEdit(); }
+}
+
+void seq_allOff(){
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    wheel_clear();
+    const uint16_t open = s_open;
+    for (uint8_t t = 0; t < NUM_INSTR; ++t) if (open & ((uint16_t)1 << t)) out(t, 0);
+    s_open = 0;
+  }
+}
+
+// ---- Groove ----
+static void applySwing() {
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    const uint8_t pct = s_trackSwing[t] ? s_trackSwing[t] : s_swing;
+    // (pct - 50) % of two steps, as a fraction of one: 75 → 128/256
+    s_swingQ8[t] = (uint8_t)(((uint16_t)(pct - SEQ_SWING_MIN) * 256 + 25) / 50);
+  }
+}
+
+static inline uint8_t clampSwing(uint8_t pct) {
+  return pct < SEQ_SWING_MIN ? SEQ_SWING_MIN : (pct > SEQ_SWING_MAX ? SEQ_SWING_MAX : pct);
+}
+
+void seq_setSwing(uint8_t percent) { s_swing = clampSwing(percent); applySwing(); }
+uint8_t seq_getSwing() { return s_swing; }
+
+void seq_setTrackSwing(uint8_t track, uint8_t percent) {
+  if (track >= NUM_INSTR) return;
+  s_trackSwing[track] = percent ? clampSwing(percent) : 0;
+  applySwing();
+}
+
+uint8_t seq_getTrackSwing(uint8_t track) { return (track < NUM_INSTR) ? s_trackSwing[track] : 0; }
+
+static inline int8_t clampNudge(int8_t n) {
+  return n < -SEQ_NUDGE_MAX ? (int8_t)-SEQ_NUDGE_MAX : (n > SEQ_NUDGE_MAX ? (int8_t)SEQ_NUDGE_MAX : n);
+}
+
+int8_t seq_getNudge(const Pattern& p, uint8_t track, uint8_t step) {
+  return (track < NUM_INSTR && step < NUM_STEPS) ? p.trk[track].nudge[step] : 0;
+}
+int8_t seq_getNudge(const PackedPattern& p, uint8_t, uint8_t step) {
+  return (step < NUM_STEPS) ? p.nudge[step] : 0;
+}
+void seq_setNudge(Pattern& p, uint8_t track, uint8_t step, int8_t ticks) {
+  if (track < NUM_INSTR && step < NUM_STEPS) p.trk[track].nudge[step] = clampNudge(ticks);
+}
+void seq_setNudge(PackedPattern& p, uint8_t, uint8_t step, int8_t ticks) {
+  if (step < NUM_STEPS) p.nudge[step] = clampNudge(ticks);
+}
+
+// ---- Editing / conversion ----
+uint8_t seq_getStep(const Pattern& p, uint8_t track, uint8_t step) {
+  return (track < NUM_INSTR && step < NUM_STEPS) ? p.trk[track].steps[step] : 0;
+}
+
+uint8_t seq_getStep(const PackedPattern& p, uint8_t track, uint8_t step) {
+  if (track >= NUM_INSTR || step >= NUM_STEPS) return 0;
+  return (p.trig[step] & ((uint16_t)1 << track)) ? hitByte(p, track, step) : 0;
+}
+
+void seq_setStep(Pattern& p, uint8_t track, uint8_t step, uint8_t v) {
+  if (track < NUM_INSTR && step < NUM_STEPS) p.trk[track].steps[step] = v;
+}
+
+// The ISR reads each plane word whole, but an AVR 16-bit store is two
+// byte stores; flip the bits with interrupts off
+void seq_setStep(PackedPattern& p, uint8_t track, uint8_t step, uint8_t v) {
+  if (track >= NUM_INSTR || step >= NUM_STEPS) return;
+  const uint16_t bit = (uint16_t)1 << track;
+  const uint8_t level = v >> SEQ_STEP_VEL_SHIFT;
+  bool empty = true;
+  for (uint8_t s = 0; s < NUM_STEPS && empty; ++s) empty = !(p.trig[s] & bit);
+  if (level && empty) p.voice[track] = v;
+  const bool accent = level > (p.voice[track] >> SEQ_STEP_VEL_SHIFT);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (level)  p.trig[step]   |= bit;
+    else        p.trig[step]   &= (uint16_t)~bit;
+    if (accent) p.accent[step] |= bit;
+    else        p.accent[step] &= (uint16_t)~bit;
+  }
+}
+
+SeqTrackCfg seq_getTrackCfg(const Pattern& p, uint8_t track) {
+  return (track < NUM_INSTR) ? cfgOf(p, track) : SeqTrackCfg{ 0, SEQ_RATE_X1, SEQ_DIR_FWD };
+}
+SeqTrackCfg seq_getTrackCfg(const PackedPattern& p, uint8_t track) {
+  return (track < NUM_INSTR) ? cfgOf(p, track) : SeqTrackCfg{ 0, SEQ_RATE_X1, SEQ_DIR_FWD };
+}
+
+// Byte stores; the ISR reads them at the track's next boundary
+void seq_setTrackCfg(Pattern& p, uint8_t track, const SeqTrackCfg& c) {
+  if (track >= NUM_INSTR) return;
+  Track& k = p.trk[track];
+  k.length = (c.length > NUM_STEPS) ? NUM_STEPS : c.length;
+  k.rate   = inRange(c.rate, SEQ_RATE_COUNT);
+  k.dir    = inRange(c.dir, SEQ_DIR_COUNT);
+}
+void seq_setTrackCfg(PackedPattern& p, uint8_t track, const SeqTrackCfg& c) {
+  if (track >= NUM_INSTR) return;
+  p.trkLength[track] = (c.length > NUM_STEPS) ? NUM_STEPS : c.length;
+  p.trkMode[track]   = (uint8_t)(inRange(c.rate, SEQ_RATE_COUNT) | (inRange(c.dir, SEQ_DIR_COUNT) << 4));
+}
+
+void seq_pack(const Pattern& in, PackedPattern& out) {
+  memset(out.trig,   0, sizeof(out.trig));
+  memset(out.accent, 0, sizeof(out.accent));
+  memset(out.nudge,  0, sizeof(out.nudge));
+  out.mute = 0;
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    out.voice[t] = SEQ_STEP_DEFAULT;
+    if (in.trk[t].mute) out.mute |= (uint16_t)1 << t;
+    seq_setTrackCfg(out, t, cfgOf(in, t));
+    for (uint8_t s = 0; s < NUM_STEPS; ++s) seq_setStep(out, t, s, in.trk[t].steps[s]);
+  }
+  // One nudge per step: the first track that plays there
+  for (uint8_t s = 0; s < NUM_STEPS; ++s)
+    for (uint8_t t = 0; t < NUM_INSTR; ++t)
+      if (in.trk[t].steps[s] & SEQ_STEP_VEL_MASK) { out.nudge[s] = in.trk[t].nudge[s]; break; }
+  out.length = in.length;
+  out.pos    = in.pos;
+}
+
+void seq_unpack(const PackedPattern& in, Pattern& out) {
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    out.trk[t].mute = (in.mute >> t) & 1;
+    seq_setTrackCfg(out, t, cfgOf(in, t));
+    for (uint8_t s = 0; s < NUM_STEPS; ++s) {
+      out.trk[t].steps[s] = seq_getStep(in, t, s);
+      out.trk[t].nudge[s] = in.nudge[s];
+    }
+  }
+  out.length = in.length;
+  out.pos    = in.pos;
+}
+
+#if SEQ_STATS
+void seq_statsReset() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { memset(&s_tickCost, 0, sizeof(s_tickCost)); s_overruns = 0; }
+}
+
+void seq_statsDump() {
+  ProfStat s;
+  uint16_t over;
+  uint8_t pending, hwm;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    s = s_tickCost; over = s_overruns;
+    pending = wheel_pending(); hwm = wheel_highWater();
+  }
+  DLLN("-- sequencer tick (us in ISR) --  n min avg max | " PROF_HIST_LEGEND);
+  prof_dumpRow("tick", s);
+  DL("over budget ("); DPRINT(SEQ_TICK_BUDGET_US); DL(" us): "); DPRINTLN(over);
+  DL("wheel jobs: "); DPRINT(pending); DL(" pending, "); DPRINT(hwm);
+  DL(" max of "); DPRINT(SEQ_WHEEL_JOBS); DL(", "); DPRINT(wheel_drops()); DLLN(" dropped");
+}
+#endif
+
+#if SEQ_BENCH
+// Same random pattern in both layouts: ~3 hits in 8 per track, random
+// level and gate, no probability (so both fire exactly the same hits)
+static void benchFill(Pattern& a, PackedPattern& b) {
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    a.trk[t].mute = false;
+    seq_setTrackCfg(a, t, SeqTrackCfg{ 0, SEQ_RATE_X1, SEQ_DIR_FWD });
+    for (uint8_t s = 0; s < NUM_STEPS; ++s) {
+      const uint8_t r = rnd8();
+      a.trk[t].steps[s] = (r < 96) ? seqStep((uint8_t)((r & 0x0F) | 1), (uint8_t)(r >> 4), SEQ_PROB_100) : 0;
+      a.trk[t].nudge[s] = 0;
+    }
+  }
+  a.length = NUM_STEPS;
+  seq_pack(a, b);
+}
+
+static volatile uint16_t s_benchSink;
+
+// The trigger word tickT() reads for the tracks on the grid, every step
+template <class P>
+static uint32_t benchTriggers(const P& p, uint8_t rounds) {
+  const uint32_t t0 = tb_now();
+  for (uint8_t r = 0; r < rounds; ++r)
+    for (uint8_t s = 0; s < NUM_STEPS; ++s) s_benchSink = triggers(p, s);
+  return tb_to_us(tb_now() - t0);
+}
+
+// Every tick of every step through the engine and the wheel
+template <class P>
+static uint32_t benchSteps(P& p, uint8_t rounds) {
+  resetT(p);
+  const uint32_t t0 = tb_now();
+  for (uint8_t r = 0; r < rounds; ++r)
+    for (uint8_t s = 0; s < NUM_STEPS; ++s)
+      for (uint8_t sub = 0; sub < SEQ_TICKS_PER_STEP; ++sub) tickT(p, sub);
+  const uint32_t us = tb_to_us(tb_now() - t0);
+  seq_allOff();
+  return us;
+}
+
+static void benchRow(const char* name, uint16_t bytes, uint32_t trigUs, uint32_t stepUs, uint16_t n) {
+  char line[48];
+  // per-step cost in 1/10 us
+  snprintf_P(line, sizeof(line), PSTR("%-8s%6u%8lu%8lu"), name, (unsigned)bytes,
+           (unsigned long)(trigUs * 10 / n), (unsigned long)(stepUs * 10 / n));
+  DPRINTLN(line);
+}
+
+void seq_benchmark() {
+  if (clk_running()) { DLLN("seq bench: stop the clock first"); return; }
+  const uint8_t ROUNDS = 32;
+  const uint16_t n = (uint16_t)ROUNDS * NUM_STEPS;
+  Pattern a;
+  PackedPattern b;
+  benchFill(a, b);
+
+  SeqOutFn saved;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { saved = s_out; s_out = nullptr; }
+  const uint32_t ta = benchTriggers(a, ROUNDS), tb = benchTriggers(b, ROUNDS);
+  const uint32_t sa = benchSteps(a, ROUNDS), sb = benchSteps(b, ROUNDS);
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { s_out = saved; }
+
+  DL("-- seq bench ("); DPRINT(n); DLLN(" steps, 1/10 us per step) --  layout bytes trig step");
+  benchRow("bytes", sizeof(Pattern), ta, sa, n);
+  benchRow("planes", sizeof(PackedPattern), tb, sb, n);
+}
+#endif // SEQ_BENCH
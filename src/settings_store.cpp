@@ -2,13 +2,19 @@
 #include "settings_store.h"
 #include <EEPROM.h>
 #include "hal_backlight.h"
+#include "render_gate.h"
+#include "seq_clock.h"
 
 // Layout: [magic:4][version:1][Settings struct:N][checksum:1]
 static const uint32_t MAGIC = 0x4F523031; // 'OR01' (Octo-Rescue v01)
-static const uint8_t  VER   = 1;
+static const uint8_t  VER   = 2;   // v2: + tempo_bpm
 
 static Settings g_settings;
 
+// Pending EEPROM image and write cursor (deferred, incremental save)
+static uint8_t s_image[sizeof(MAGIC) + sizeof(VER) + sizeof(Settings) + 1];
+static uint8_t s_writePos = sizeof(s_image);   // == size → nothing pending
+
 static uint8_t simple_checksum(const uint8_t* p, size_t n) {
   uint16_t s = 0;
   for (size_t i = 0; i < n; ++i) s += p[i];
@@ -21,6 +27,7 @@ static void set_defaults(Settings& s) {
   s.ws_brightness  = 128;
   s.ws_hit_color   = 0xFFFFFF; // white
   s.ws_step_color  = 0x00FF00; // green
+  s.tempo_bpm      = SEQ_BPM_DEFAULT;
 }
 
 void settings_init() {
@@ -50,17 +57,32 @@ void settings_init() {
 Settings& settings_get() { return g_settings; }
 
 void settings_save() {
+  // Snapshot now; settings_service() trickles it out without blocking the UI
   size_t addr = 0;
-  EEPROM.put(addr, MAGIC); addr += sizeof(MAGIC);
-  EEPROM.put(addr, VER);   addr += sizeof(VER);
-  EEPROM.put(addr, g_settings); addr += sizeof(g_settings);
-  uint8_t chk = simple_checksum((const uint8_t*)&g_settings, sizeof(g_settings));
-  EEPROM.put(addr, chk);
+  memcpy(&s_image[addr], &MAGIC, sizeof(MAGIC)); addr += sizeof(MAGIC);
+  memcpy(&s_image[addr], &VER, sizeof(VER));     addr += sizeof(VER);
+  memcpy(&s_image[addr], &g_settings, sizeof(g_settings)); addr += sizeof(g_settings);
+  s_image[addr] = simple_checksum((const uint8_t*)&g_settings, sizeof(g_settings));
+  s_writePos = 0;
 }
 
+void settings_service() {
+  // Skip unchanged bytes (reads are cheap), write at most one per call
+  while (s_writePos < sizeof(s_image)) {
+    const uint8_t i = s_writePos++;
+    if (EEPROM.read(i) != s_image[i]) { EEPROM.write(i, s_image[i]); return; }
+  }
+}
+
+bool settings_save_pending() { return s_writePos < sizeof(s_image); }
+
 void settings_apply_runtime() {
   // Backlight: apply max percent and invert live
   bl_set_max_percent(settings_get().bl_max_percent);
   bl_set_invert(settings_get().bl_invert != 0);
+  // Sequencer clock tempo (takes effect on the next tick)
+  clk_set_bpm(settings_get().tempo_bpm);
+  // Invert and friends are applied at draw time → repaint
+  render_invalidate();
 }
 
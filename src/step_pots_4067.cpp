@@ -1,13 +1,23 @@
 // step_pots_4067.cpp
 #include <Arduino.h>
 #include "config.h"
-void stepPots_init(){ pinMode(PIN_MUX_EN, OUTPUT); digitalWrite(PIN_MUX_EN, LOW); }
-static void muxSel(uint8_t i){
-digitalWrite(PIN_MUX_S0, i&1); digitalWrite(PIN_MUX_S1, (i>>1)&1);
-digitalWrite(PIN_MUX_S2, (i>>2)&1); digitalWrite(PIN_MUX_S3, (i>>3)&1);
+#include "step_pots_4067.h"
+#include "adc_scan.h"
+#include "debug.h"
+
+// adc_scan selects a channel with one write to MUX_SEL_PORT, so S0..S3
+// must sit on consecutive bits of that port (board_profile)
+static void checkPin(uint8_t pin, uint8_t bit) {
+  if (portOutputRegister(digitalPinToPort(pin)) != &MUX_SEL_PORT ||
+      digitalPinToBitMask(pin) != _BV(bit)) {
+    DL("steppots: pin "); DPRINT(pin); DLLN(" doesn't match board_profile port bit");
+  }
 }
-uint16_t stepPots_read(uint8_t idx){
-muxSel(idx&0x0F);
-delayMicroseconds(5); // settle
-return analogRead(PIN_MUX_SIG);
-}
\ No newline at end of file
+
+void stepPots_init(){
+checkPin(PIN_MUX_S0, MUX_SEL_SHIFT);     checkPin(PIN_MUX_S1, MUX_SEL_SHIFT + 1);
+checkPin(PIN_MUX_S2, MUX_SEL_SHIFT + 2); checkPin(PIN_MUX_S3, MUX_SEL_SHIFT + 3);
+pinMode(PIN_MUX_S0, OUTPUT); pinMode(PIN_MUX_S1, OUTPUT);
+pinMode(PIN_MUX_S2, OUTPUT); pinMode(PIN_MUX_S3, OUTPUT);
+pinMode(PIN_MUX_EN, OUTPUT); digitalWrite(PIN_MUX_EN, LOW); }
+uint16_t stepPots_value(uint8_t idx){ return adc_value(ADC_CH_STEP0 + (idx&0x0F)); }
@@ -0,0 +1,45 @@
+// timebase.cpp
+#include <Arduino.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include "timebase.h"
+
+static volatile uint16_t s_ovf = 0;   // high 16 bits of the timebase
+
+ISR(TIMER5_OVF_vect) { s_ovf++; }
+
+void tb_init() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TCCR5A = 0;               // normal mode, OC5x pins disconnected
+    TCCR5B = _BV(CS51);       // clk/8 → 2 MHz
+    TCNT5  = 0;
+    TIFR5  = _BV(TOV5);
+    TIMSK5 = _BV(TOIE5);
+    s_ovf  = 0;
+  }
+}
+
+uint32_t tb_nowISR() {
+  uint16_t lo = TCNT5;
+  uint16_t hi = s_ovf;
+  // Overflow happened but its ISR hasn't run yet (we're in a critical section)
+  if ((TIFR5 & _BV(TOV5)) && lo < 0x8000) hi++;
+  return ((uint32_t)hi << 16) | lo;
+}
+
+uint32_t tb_now() {
+  // Re-read until the overflow count is the same on both sides of the
+  // counter read. With interrupts on, a pending overflow is serviced
+  // within an instruction, so a changed s_ovf always shows up here.
+  if (!(SREG & _BV(SREG_I))) return tb_nowISR();   // called with interrupts off
+  uint16_t hi, lo;
+  do {
+    hi = s_ovf;
+    // The two byte reads share the timer TEMP register with every ISR
+    // that reads a 16-bit timer; one landing in between would hand us
+    // its high byte. Only the read itself is shielded (a few cycles).
+    ATOMIC_BLOCK(ATOMIC_FORCEON) { lo = TCNT5; }
+  } while (hi != s_ovf);
+  return ((uint32_t)hi << 16) | lo;
+}
@@ -0,0 +1,75 @@
+// timing_wheel.cpp
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "timing_wheel.h"
+
+static_assert((SEQ_WHEEL_SLOTS & (SEQ_WHEEL_SLOTS - 1)) == 0 && SEQ_WHEEL_SLOTS <= 256,
+              "SEQ_WHEEL_SLOTS must be a power of two <= 256");
+static_assert(SEQ_WHEEL_JOBS < 255, "job indices are bytes, 0xFF = none");
+#define WHEEL_MASK (SEQ_WHEEL_SLOTS - 1)
+#define NIL 0xFF
+
+struct Job {
+  uint8_t next;
+  uint8_t track, vel, gen;
+};
+
+static Job     s_job[SEQ_WHEEL_JOBS];
+static uint8_t s_slot[SEQ_WHEEL_SLOTS];   // list head per tick
+static uint8_t s_free = NIL;              // free list head
+static uint8_t s_now = 0;                 // slot of the current tick
+static uint8_t s_used = 0, s_hwm = 0;
+static uint16_t s_drops = 0;
+static bool s_ready = false;
+
+static void reset() {
+  memset(s_slot, NIL, sizeof(s_slot));
+  for (uint8_t i = 0; i < SEQ_WHEEL_JOBS; ++i) s_job[i].next = (uint8_t)(i + 1);
+  s_job[SEQ_WHEEL_JOBS - 1].next = NIL;
+  s_free  = 0;
+  s_used  = 0;
+  s_ready = true;
+}
+
+bool wheel_schedule(uint8_t delay, uint8_t track, uint8_t vel, uint8_t gen) {
+  if (!s_ready) reset();
+  const uint8_t j = s_free;
+  if (j == NIL || delay > WHEEL_MASK) {
+    if (s_drops != 0xFFFF) s_drops++;
+    return false;
+  }
+  Job& job = s_job[j];
+  s_free    = job.next;
+  job.track = track;
+  job.vel   = vel;
+  job.gen   = gen;
+  const uint8_t slot = (uint8_t)((s_now + delay) & WHEEL_MASK);
+  job.next     = s_slot[slot];
+  s_slot[slot] = j;
+  if (++s_used > s_hwm) s_hwm = s_used;
+  return true;
+}
+
+void wheel_tick(WheelFire fire) {
+  if (!s_ready) reset();
+  uint8_t j = s_slot[s_now];
+  s_slot[s_now] = NIL;
+  s_now = (uint8_t)((s_now + 1) & WHEEL_MASK);
+  while (j != NIL) {
+    Job& job = s_job[j];
+    const uint8_t next = job.next;
+    fire(job.track, job.vel, job.gen);
+    job.next = s_free;
+    s_free   = j;
+    s_used--;
+    j = next;
+  }
+}
+
+void wheel_clear() {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { reset(); }
+}
+
+uint8_t  wheel_pending()   { return s_used; }
+uint8_t  wheel_highWater() { return s_hwm; }
+uint16_t wheel_drops()     { uint16_t d; ATOMIC_BLOCK(ATOMIC_RESTORESTATE) { d = s_drops; } return d; }
@@ -0,0 +1,237 @@
+// twi.cpp
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "twi.h"
+#include "config.h"
+#include "event_bus.h"
+#include "LoopManager.h"
+#include "debug.h"
+
+static_assert((TWI_QUEUE_LEN & (TWI_QUEUE_LEN - 1)) == 0, "TWI_QUEUE_LEN must be a power of two");
+#define TWI_MASK (TWI_QUEUE_LEN - 1)
+
+// TWSR status codes (master transmitter / receiver)
+#define TWS_START      0x08
+#define TWS_REP_START  0x10
+#define TWS_SLA_W_ACK  0x18
+#define TWS_SLA_W_NACK 0x20
+#define TWS_DATA_ACK   0x28
+#define TWS_DATA_NACK  0x30
+#define TWS_ARB_LOST   0x38
+#define TWS_SLA_R_ACK  0x40
+#define TWS_SLA_R_NACK 0x48
+#define TWS_RX_ACK     0x50
+#define TWS_RX_NACK    0x58
+
+#define TWCR_ARM (_BV(TWEN) | _BV(TWIE))
+#define TWCR_GO  (TWCR_ARM | _BV(TWINT))
+
+struct Job {
+  uint8_t addr;
+  uint8_t txLen, rxLen;
+  uint8_t tx[TWI_TX_MAX];
+  uint8_t* rx;
+  TwiDone done;
+  uint8_t tag;
+  volatile uint8_t status;
+};
+
+// Ring of jobs: submitted at head (main), run at cur (ISR), retired at
+// tail (main) once their callback has been called.
+static Job q[TWI_QUEUE_LEN];
+static volatile uint8_t s_head = 0, s_cur = 0;
+static uint8_t s_tail = 0;
+static volatile uint8_t s_busy = 0;   // a job is on the bus (ISR chain running)
+static bool s_ready = false;
+
+// Position within the job on the bus (ISR only)
+static uint8_t s_idx = 0;
+static uint8_t s_rx  = 0;             // 1 = read phase
+
+// Watchdog (main loop): which job we saw on the bus, and since when
+static uint8_t s_watchIdx = 0;
+static bool s_watching = false;
+static unsigned long s_watchSince = 0;
+
+static int8_t s_task = -1;
+static uint16_t s_errors = 0;
+
+// Put the job at s_cur on the bus (ISR or interrupts off)
+static inline void startJob(uint8_t extra) {
+  const Job& j = q[s_cur];
+  s_idx = 0;
+  s_rx  = (j.txLen == 0 && j.rxLen != 0);
+  TWCR  = TWCR_GO | _BV(TWSTA) | extra;
+}
+
+static void finish(uint8_t status, bool stop) {
+  q[s_cur].status = status;
+  s_cur = (uint8_t)((s_cur + 1) & TWI_MASK);
+  const uint8_t stopBit = stop ? _BV(TWSTO) : 0;
+  if (s_cur != s_head) {
+    startJob(stopBit);                 // STOP, then START for the next job
+  } else {
+    TWCR = TWCR_GO | stopBit;
+    s_busy = 0;
+  }
+  triggerLoopTask(s_task);
+}
+
+ISR(TWI_vect) {
+  Job& j = q[s_cur];
+  switch (TWSR & 0xF8) {
+    case TWS_START:
+    case TWS_REP_START:
+      TWDR = (uint8_t)((j.addr << 1) | s_rx);
+      TWCR = TWCR_GO;
+      break;
+    case TWS_SLA_W_ACK:
+    case TWS_DATA_ACK:
+      if (s_idx < j.txLen) {
+        TWDR = j.tx[s_idx++];
+        TWCR = TWCR_GO;
+      } else if (j.rxLen) {
+        s_rx = 1; s_idx = 0;
+        TWCR = TWCR_GO | _BV(TWSTA);   // repeated start for the read
+      } else {
+        finish(TWI_OK, true);
+      }
+      break;
+    case TWS_SLA_R_ACK:
+      TWCR = TWCR_GO | ((j.rxLen > 1) ? _BV(TWEA) : 0);
+      break;
+    case TWS_RX_ACK:
+      j.rx[s_idx++] = TWDR;
+      TWCR = TWCR_GO | ((uint8_t)(s_idx + 1) < j.rxLen ? _BV(TWEA) : 0);
+      break;
+    case TWS_RX_NACK:
+      j.rx[s_idx++] = TWDR;
+      finish(TWI_OK, true);
+      break;
+    case TWS_SLA_W_NACK:
+    case TWS_SLA_R_NACK: finish(TWI_NACK_ADDR, true);  break;
+    case TWS_DATA_NACK:  finish(TWI_NACK_DATA, true);  break;
+    case TWS_ARB_LOST:   finish(TWI_ARB_LOST, false);  break;   // bus isn't ours to stop
+    default:             finish(TWI_BUS_ERROR, true);  break;   // TWSTO releases the lines
+  }
+}
+
+void twi_init(uint32_t hz) {
+  pinMode(PIN_I2C_SDA, INPUT_PULLUP);
+  pinMode(PIN_I2C_SCL, INPUT_PULLUP);
+  TWSR = 0;                                         // prescaler 1
+  TWBR = (uint8_t)(((F_CPU / hz) - 16) / 2);
+  TWCR = TWCR_ARM;
+  s_ready = true;
+}
+
+void twi_setTask(int8_t taskId) { s_task = taskId; }
+
+bool twi_submit(uint8_t addr, const uint8_t* tx, uint8_t txLen,
+                uint8_t* rx, uint8_t rxLen, TwiDone done, uint8_t tag) {
+  if (!s_ready || txLen > TWI_TX_MAX || (rxLen && !rx)) return false;
+  const uint8_t h = s_head;
+  const uint8_t n = (uint8_t)((h + 1) & TWI_MASK);
+  if (n == s_tail) return false;                    // full
+  Job& j = q[h];
+  j.addr  = addr;
+  j.txLen = txLen;
+  j.rxLen = rxLen;
+  if (txLen) memcpy(j.tx, tx, txLen);
+  j.rx     = rx;
+  j.done   = done;
+  j.tag    = tag;
+  j.status = TWI_PENDING;
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    s_head = n;
+    if (!s_busy) { s_busy = 1; startJob(0); }
+  }
+  return true;
+}
+
+uint8_t twi_free() { return (uint8_t)(TWI_MASK - ((s_head - s_tail) & TWI_MASK)); }
+bool twi_idle()    { return !s_busy && s_tail == s_head; }
+uint16_t twi_errorCount() { return s_errors; }
+
+// Clock out a slave that is holding SDA low, then leave a STOP
+static void recoverBus() {
+  pinMode(PIN_I2C_SCL, OUTPUT);
+  for (uint8_t i = 0; i < 9 && digitalRead(PIN_I2C_SDA) == LOW; ++i) {
+    digitalWrite(PIN_I2C_SCL, LOW);  delayMicroseconds(5);
+    digitalWrite(PIN_I2C_SCL, HIGH); delayMicroseconds(5);
+  }
+  pinMode(PIN_I2C_SDA, OUTPUT);
+  digitalWrite(PIN_I2C_SDA, LOW);  delayMicroseconds(5);
+  digitalWrite(PIN_I2C_SDA, HIGH); delayMicroseconds(5);   // SDA rises while SCL is high
+  pinMode(PIN_I2C_SDA, INPUT_PULLUP);
+  pinMode(PIN_I2C_SCL, INPUT_PULLUP);
+}
+
+// Give up on job cur, reset the bus, carry on with the next one
+static void abortCurrent(uint8_t cur) {
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    if (!s_busy || s_cur != cur) return;            // it finished after all
+    TWCR = 0;                                       // peripheral off, lines released
+    q[s_cur].status = TWI_TIMEOUT;
+    s_cur = (uint8_t)((s_cur + 1) & TWI_MASK);
+  }
+  recoverBus();
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    TWCR = TWCR_ARM;
+    if (s_cur != s_head) startJob(0);
+    else s_busy = 0;
+  }
+}
+
+static void pushError(uint8_t status, uint8_t addr) {
+  if (s_errors != 0xFFFF) s_errors++;
+  Event e;
+  e.type = EVT_BUS_ERROR;
+  e.src  = SRC_I2C;
+  e.a    = status;
+  e.b    = addr;
+  eb_push(e);
+  DL("twi: error "); DPRINT(status); DL(" @0x"); DPRINTLN(addr, HEX);
+}
+
+void twi_poll() {
+  // Retire finished jobs in order; free the slot first so a callback can
+  // queue follow-up work
+  while (s_tail != s_cur) {
+    const Job& j = q[s_tail];
+    const uint8_t st = j.status, tag = j.tag, addr = j.addr;
+    const TwiDone cb = j.done;
+    s_tail = (uint8_t)((s_tail + 1) & TWI_MASK);
+    if (st == TWI_TIMEOUT || st == TWI_BUS_ERROR) pushError(st, addr);
+    if (cb) cb(st, tag);
+  }
+
+  if (!s_busy) { s_watching = false; return; }
+  const uint8_t cur = s_cur;
+  const unsigned long now = millis();
+  if (!s_watching || cur != s_watchIdx) {
+    s_watching = true;
+    s_watchIdx = cur;
+    s_watchSince = now;
+  } else if ((now - s_watchSince) >= TWI_TIMEOUT_MS) {
+    s_watching = false;
+    abortCurrent(cur);
+    triggerLoopTask(s_task);                        // retire it on the next run
+    return;
+  }
+  wakeLoopTaskIn(s_task, TWI_TIMEOUT_MS);           // come back to check
+}
+
+static volatile uint8_t s_syncStatus;
+static void syncDone(uint8_t status, uint8_t) { s_syncStatus = status; }
+
+uint8_t twi_runSync(uint8_t addr, const uint8_t* tx, uint8_t txLen, uint8_t* rx, uint8_t rxLen) {
+  if (!s_ready) return TWI_BUS_ERROR;
+  s_syncStatus = TWI_PENDING;
+  while (!twi_submit(addr, tx, txLen, rx, rxLen, syncDone, 0)) {
+    if (txLen > TWI_TX_MAX || (rxLen && !rx)) return TWI_BUS_ERROR;
+    twi_poll();                                     // queue full: let it drain
+  }
+  while (s_syncStatus == TWI_PENDING) twi_poll();
+  return s_syncStatus;
+}
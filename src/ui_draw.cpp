@@ -0,0 +1,193 @@
+// ui_draw.cpp
+// Retained layout cache behind drawTitleWithLines_P / drawMenuPagedP_P /
+// drawOptionRowsP_P.
+#include "ui_draw.h"
+
+struct TitleLayout {
+  const char* keyP;          // PROGMEM title this entry was built from
+  int16_t x;
+  uint8_t w;
+  char text[UI_TEXT_MAX];
+};
+
+struct MenuLayout {
+  const char* const* itemsP; // PROGMEM item table; identifies the menu
+  uint8_t count, rows, start;
+  TitleLayout title;
+  char row[UI_ROWS_MAX][UI_TEXT_MAX];
+  int16_t knobY;             // scrollbar knob, knobH 0 = no scrollbar
+  uint8_t knobH;
+};
+
+static TitleLayout s_titles[UI_TITLE_SLOTS];
+static uint8_t     s_titleNext = 0;
+static MenuLayout  s_menus[UI_MENU_SLOTS];
+static uint8_t     s_menuNext = 0;
+
+static void copyP(char* dst, const char* p) {
+  strncpy_P(dst, p, UI_TEXT_MAX - 1);
+  dst[UI_TEXT_MAX - 1] = '\0';
+}
+
+static void buildTitle(U8G2* gfx, TitleLayout& t, const char* titleP) {
+  t.keyP = titleP;
+  copyP(t.text, titleP);
+  gfx->setFont(u8g2_font_6x13_tf);
+  const int W = gfx->getDisplayWidth();
+  const int txt = gfx->getUTF8Width(t.text);
+  t.w = (uint8_t)txt;
+  t.x = (int16_t)((W - txt) / 2); if (t.x < 0) t.x = 0;
+}
+
+static void drawTitle(U8G2* gfx, const TitleLayout& t, int y, int gapPx) {
+  gfx->setFont(u8g2_font_6x13_tf);
+  gfx->drawStr(t.x, y, t.text);
+
+  const int W       = gfx->getDisplayWidth();
+  const int lineY   = y - 5;
+  const int leftEnd = t.x - gapPx;
+  const int rightBeg= t.x + t.w + gapPx;
+
+  if (leftEnd > 0)  gfx->drawHLine(0,        lineY, leftEnd);
+  if (rightBeg < W) gfx->drawHLine(rightBeg, lineY, W - rightBeg);
+}
+
+void drawTitleWithLines_P(U8G2* gfx, const char* titleP, int y, int gapPx) {
+  if (!gfx || !titleP) return;
+
+  TitleLayout* t = nullptr;
+  for (uint8_t i = 0; i < UI_TITLE_SLOTS; ++i) {
+    if (s_titles[i].keyP == titleP) { t = &s_titles[i]; break; }
+  }
+  if (!t) {
+    t = &s_titles[s_titleNext];
+    s_titleNext = (uint8_t)((s_titleNext + 1) % UI_TITLE_SLOTS);
+    buildTitle(gfx, *t, titleP);
+  }
+  drawTitle(gfx, *t, y, gapPx);
+}
+
+// Same window rule as drawMenuPagedP: keep the selection centred
+static uint8_t windowStart(uint8_t count, uint8_t selected, uint8_t rows) {
+  if (count <= rows) return 0;
+  const uint8_t maxStart = count - rows;
+  int center = (int)selected - (int)rows / 2;
+  if (center < 0) center = 0;
+  if ((uint8_t)center > maxStart) center = (int)maxStart;
+  return (uint8_t)center;
+}
+
+static void buildRows(MenuLayout& m) {
+  for (uint8_t r = 0; r < m.rows && (m.start + r) < m.count; ++r) {
+    copyP(m.row[r], readPtrP(m.itemsP, m.start + r));
+  }
+  m.knobH = 0;
+  if (m.count > m.rows) {
+    const int barTop = 16, barH = 48;
+    const uint8_t maxStart = m.count - m.rows;
+    int knobH = (m.rows * barH) / (int)m.count; if (knobH < 6) knobH = 6;
+    const int numer = (int)m.start * (barH - knobH);
+    m.knobY = (int16_t)(barTop + numer / (int)maxStart);
+    m.knobH = (uint8_t)knobH;
+  }
+}
+
+static MenuLayout& menuLayout(U8G2* gfx, const char* titleP, const char* const* itemsP,
+                              uint8_t count, uint8_t rows, uint8_t start) {
+  MenuLayout* m = nullptr;
+  for (uint8_t i = 0; i < UI_MENU_SLOTS; ++i) {
+    if (s_menus[i].itemsP == itemsP) { m = &s_menus[i]; break; }
+  }
+  if (!m) {
+    m = &s_menus[s_menuNext];
+    s_menuNext = (uint8_t)((s_menuNext + 1) % UI_MENU_SLOTS);
+    m->itemsP = itemsP;
+    m->title.keyP = nullptr;
+    m->count = 0;   // forces the row rebuild below
+  }
+  if (m->title.keyP != titleP) buildTitle(gfx, m->title, titleP);
+  if (m->count != count || m->rows != rows || m->start != start) {
+    m->count = count; m->rows = rows; m->start = start;
+    buildRows(*m);
+  }
+  return *m;
+}
+
+void drawMenuPagedP_P(U8G2* gfx,
+                      const char* titleP,
+                      const char* const* itemsP,
+                      uint8_t count,
+                      uint8_t selected,
+                      uint8_t rows)
+{
+  if (!gfx || !titleP || !itemsP) return;
+  if (rows < 1) rows = 1;
+  if (rows > UI_ROWS_MAX) rows = UI_ROWS_MAX;
+
+  const MenuLayout& m =
+    menuLayout(gfx, titleP, itemsP, count, rows, windowStart(count, selected, rows));
+
+  gfx->firstPage();
+  do {
+    drawTitle(gfx, m.title, 12, 6);
+
+    gfx->setFont(u8g2_font_6x10_tf);
+    const int startY = 26;
+    const int lineH  = 12;
+
+    for (uint8_t row = 0; row < rows && (m.start + row) < count; ++row) {
+      const int y = startY + row * lineH;
+      if ((uint8_t)(m.start + row) == selected) {
+        gfx->drawBox(0, y - 10, 128, 12);
+        gfx->setDrawColor(0);
+        gfx->drawStr(4, y, m.row[row]);
+        gfx->setDrawColor(1);
+      } else {
+        gfx->drawStr(4, y, m.row[row]);
+      }
+    }
+
+    if (m.knobH) {
+      gfx->drawVLine(125, 16, 48);
+      gfx->drawBox(124, m.knobY, 3, m.knobH);
+    }
+    // Apply global invert at end of page
+    applyInvertIfEnabled(gfx);
+  } while (gfx->nextPage());
+}
+
+void drawOptionRowsP_P(U8G2* gfx,
+                       const char* titleP,
+                       const char* const* labelsP,
+                       const char* const* values,
+                       uint8_t count,
+                       uint8_t selected)
+{
+  if (!gfx || !titleP || !labelsP || !values) return;
+  if (count > UI_ROWS_MAX) count = UI_ROWS_MAX;
+
+  const MenuLayout& m = menuLayout(gfx, titleP, labelsP, count, UI_ROWS_MAX, 0);
+
+  gfx->firstPage();
+  do {
+    drawTitle(gfx, m.title, 12, 6);
+
+    gfx->setFont(u8g2_font_6x10_tf);
+    const int W = gfx->getDisplayWidth();
+    for (uint8_t row = 0; row < count; ++row) {
+      const int y = 26 + row * 12;
+      const bool sel = (row == selected);
+      if (sel) { gfx->drawBox(0, y - 10, 128, 12); gfx->setDrawColor(0); }
+      if (values[row]) {
+        gfx->drawStr(4, y, m.row[row]);
+        gfx->drawStr(W - gfx->getUTF8Width(values[row]) - 4, y, values[row]);
+      } else if (sel) {
+        gfx->drawStr(4, y, ">");
+        gfx->drawStr(16, y, m.row[row]);
+      } else {
+        gfx->drawStr(4, y, m.row[row]);
+      }
+      if (sel) gfx->setDrawColor(1);
+    }
+  } while (gfx->nextPage());
+}
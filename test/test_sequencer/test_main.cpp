@@ -0,0 +1,256 @@
+// test_main.cpp
+// Sequencer engine on the target: `pio test -e mega2560_debug`.
+// The clock is never started, so seq_tick() is driven from here, one call
+// per clock tick, and seq_commit() swaps at once.
+#include <Arduino.h>
+#include <unity.h>
+#include "sequencer_core.h"
+#include "timing_wheel.h"
+
+static const uint16_t T   = SEQ_TICKS_PER_STEP;
+static const uint16_t BAR = (uint16_t)NUM_STEPS * SEQ_TICKS_PER_STEP;
+
+// ---- Output capture ----
+static uint16_t s_now;                   // tick being played
+static uint16_t s_ons[NUM_INSTR];
+static uint16_t s_offs;
+static uint16_t s_first[NUM_INSTR][4];   // ticks of each track's first hits
+static uint32_t s_sum;                   // order-sensitive digest of every event
+
+static void capture(uint8_t track, uint8_t vel) {
+  s_sum = s_sum * 31u + ((uint32_t)s_now << 16) + ((uint16_t)track << 8) + vel;
+  if (!vel) { s_offs++; return; }
+  if (s_ons[track] < 4) s_first[track][s_ons[track]] = s_now;
+  s_ons[track]++;
+}
+
+static Pattern s_pat;                    // scratch, too big for the stack
+
+// All rests, X1/forward, full-length bar
+static Pattern& freshPattern() {
+  memset((void*)&s_pat, 0, sizeof(s_pat));
+  s_pat.length = NUM_STEPS;
+  return s_pat;
+}
+
+static void fill(Pattern& p, uint8_t track, uint8_t v) {
+  for (uint8_t s = 0; s < NUM_STEPS; ++s) seq_setStep(p, track, s, v);
+}
+
+// Hand a pattern to the engine and rewind
+static void play(const Pattern& p) {
+  SeqPattern* w = seq_edit();
+  TEST_ASSERT_NOT_NULL(w);
+#if SEQ_PACKED
+  seq_pack(p, *w);
+#else
+  *w = p;
+#endif
+  seq_commit(SEQ_QUANT_BAR);
+  seq_allOff();
+  seq_reset();
+  memset(s_ons, 0, sizeof(s_ons));
+  memset(s_first, 0, sizeof(s_first));
+  s_offs = 0;
+  s_sum = 0;
+}
+
+static void run(uint16_t ticks) {
+  for (s_now = 0; s_now < ticks; ++s_now) seq_tick((uint8_t)(s_now % T));
+}
+
+void setUp() {
+  seq_setOutput(capture);
+  seq_setSwing(SEQ_SWING_MIN);
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) seq_setTrackSwing(t, 0);
+}
+
+void tearDown() {
+  seq_allOff();
+  seq_setOutput(nullptr);
+}
+
+// ---- Layouts ----
+
+static void test_pack_roundtrip() {
+  Pattern& a = freshPattern();
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    const uint8_t v = seqStep((uint8_t)(4 + t % 8), (uint8_t)(t & 3), SEQ_PROB_100);
+    for (uint8_t s = 0; s < NUM_STEPS; ++s)
+      if ((t * 7 + s * 3) % 5 < 2) seq_setStep(a, t, s, v);
+  }
+  a.trk[3].mute = true;
+  seq_setTrackCfg(a, 2, SeqTrackCfg{ 5, SEQ_RATE_D2, SEQ_DIR_PINGPONG });
+
+  static PackedPattern b;
+  static Pattern c;
+  seq_pack(a, b);
+  seq_unpack(b, c);
+  // One voice per track, so nothing is lost
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) {
+    TEST_ASSERT_EQUAL(a.trk[t].mute, c.trk[t].mute);
+    for (uint8_t s = 0; s < NUM_STEPS; ++s)
+      TEST_ASSERT_EQUAL_HEX8(seq_getStep(a, t, s), seq_getStep(c, t, s));
+  }
+  const SeqTrackCfg k = seq_getTrackCfg(c, 2);
+  TEST_ASSERT_EQUAL(5, k.length);
+  TEST_ASSERT_EQUAL(SEQ_RATE_D2, k.rate);
+  TEST_ASSERT_EQUAL(SEQ_DIR_PINGPONG, k.dir);
+}
+
+static void test_layouts_fire_alike() {
+  Pattern& a = freshPattern();
+  for (uint8_t t = 0; t < NUM_INSTR; ++t)
+    for (uint8_t s = 0; s < NUM_STEPS; ++s)
+      if ((t + s) % 3 == 0) seq_setStep(a, t, s, seqStep(10, SEQ_GATE_50, SEQ_PROB_100));
+  play(a);
+  run(2 * BAR);
+  const uint32_t direct = s_sum;
+
+  static PackedPattern b;
+  static Pattern c;
+  seq_pack(a, b);
+  seq_unpack(b, c);
+  play(c);
+  run(2 * BAR);
+  TEST_ASSERT_EQUAL_HEX32(direct, s_sum);
+}
+
+// ---- Groove ----
+
+static void test_swing_delays_offbeats() {
+  Pattern& a = freshPattern();
+  fill(a, 0, SEQ_STEP_DEFAULT);
+  seq_setSwing(66);
+  play(a);
+  run(4 * T);
+  // (66 - 50) % of two steps, to the tick
+  const uint16_t late = (uint16_t)((16u * 2 * T + 50) / 100);
+  TEST_ASSERT_EQUAL(0, s_first[0][0]);
+  TEST_ASSERT_UINT16_WITHIN(1, T + late, s_first[0][1]);
+  TEST_ASSERT_EQUAL(2 * T, s_first[0][2]);
+  TEST_ASSERT_UINT16_WITHIN(1, 3 * T + late, s_first[0][3]);
+
+  seq_setSwing(SEQ_SWING_MAX);
+  play(a);
+  run(2 * T);
+  TEST_ASSERT_EQUAL(T + T / 2, s_first[0][1]);   // half a step
+}
+
+static void test_nudges_clamp() {
+  Pattern& a = freshPattern();
+  seq_setStep(a, 0, 0, SEQ_STEP_DEFAULT);
+  seq_setStep(a, 0, 2, SEQ_STEP_DEFAULT);
+  seq_setStep(a, 0, 4, SEQ_STEP_DEFAULT);
+  seq_setNudge(a, 0, 2, -5);
+  seq_setNudge(a, 0, 4, 100);
+  play(a);
+  run(6 * T);
+  const uint16_t early = 5 < SEQ_NUDGE_MAX ? 5 : SEQ_NUDGE_MAX;
+  TEST_ASSERT_EQUAL(3, s_ons[0]);
+  TEST_ASSERT_EQUAL(2 * T - early, s_first[0][1]);
+  TEST_ASSERT_EQUAL(4 * T + SEQ_NUDGE_MAX, s_first[0][2]);
+}
+
+static void test_gates_balance() {
+  Pattern& a = freshPattern();
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) fill(a, t, seqStep(9, (uint8_t)(t & 3), SEQ_PROB_100));
+  seq_setSwing(60);
+  const uint16_t drops = wheel_drops();
+  play(a);
+  run(2 * BAR);
+  seq_allOff();
+  uint16_t ons = 0;
+  for (uint8_t t = 0; t < NUM_INSTR; ++t) ons += s_ons[t];
+  TEST_ASSERT_EQUAL((uint16_t)NUM_INSTR * NUM_STEPS * 2, ons);
+  TEST_ASSERT_EQUAL(ons, s_offs);
+  TEST_ASSERT_EQUAL(drops, wheel_drops());
+  TEST_ASSERT_EQUAL(0, seq_gates());
+}
+
+// ---- Polymeter ----
+
+static void test_rate_hit_counts() {
+  Pattern& a = freshPattern();
+  for (uint8_t t = 0; t < 5; ++t) fill(a, t, SEQ_STEP_DEFAULT);
+  seq_setTrackCfg(a, 1, SeqTrackCfg{ 0, SEQ_RATE_X2,   SEQ_DIR_FWD });
+  seq_setTrackCfg(a, 2, SeqTrackCfg{ 0, SEQ_RATE_D2,   SEQ_DIR_FWD });
+  seq_setTrackCfg(a, 3, SeqTrackCfg{ 0, SEQ_RATE_X3_2, SEQ_DIR_RANDOM });
+  seq_setTrackCfg(a, 4, SeqTrackCfg{ 0, SEQ_RATE_D8,   SEQ_DIR_FWD });
+  play(a);
+  run(4 * BAR);
+  TEST_ASSERT_EQUAL(4 * NUM_STEPS, s_ons[0]);
+  TEST_ASSERT_EQUAL(8 * NUM_STEPS, s_ons[1]);
+  TEST_ASSERT_EQUAL(2 * NUM_STEPS, s_ons[2]);
+  TEST_ASSERT_EQUAL(6 * NUM_STEPS, s_ons[3]);
+  TEST_ASSERT_EQUAL(NUM_STEPS / 2, s_ons[4]);
+}
+
+static void test_directions() {
+  Pattern& a = freshPattern();
+  seq_setTrackCfg(a, 0, SeqTrackCfg{ 3, SEQ_RATE_X1, SEQ_DIR_REV });
+  seq_setTrackCfg(a, 1, SeqTrackCfg{ 4, SEQ_RATE_X1, SEQ_DIR_PINGPONG });
+  play(a);
+  static const uint8_t REV[8]  = { 2, 1, 0, 2, 1, 0, 2, 1 };
+  static const uint8_t PING[8] = { 0, 1, 2, 3, 2, 1, 0, 1 };
+  for (s_now = 0; s_now < 8 * T; ++s_now) {
+    seq_tick((uint8_t)(s_now % T));
+    if (s_now % T) continue;
+    TEST_ASSERT_EQUAL(REV[s_now / T],  seq_trackPos(0));
+    TEST_ASSERT_EQUAL(PING[s_now / T], seq_trackPos(1));
+  }
+}
+
+// Tracks off the bar grid (own length, muted, short bar) next to ones on it
+static void test_off_grid_lengths() {
+  Pattern& a = freshPattern();
+  for (uint8_t t = 0; t < 4; ++t) seq_setStep(a, t, 0, SEQ_STEP_DEFAULT);
+  seq_setTrackCfg(a, 1, SeqTrackCfg{ 7, SEQ_RATE_X1, SEQ_DIR_FWD });
+  a.trk[2].mute = true;
+  seq_setTrackCfg(a, 3, SeqTrackCfg{ 5, SEQ_RATE_X1, SEQ_DIR_REV });
+  a.length = 12;
+  play(a);
+  run(4 * BAR);
+  const uint8_t steps = 4 * NUM_STEPS;
+  TEST_ASSERT_EQUAL((steps + 11) / 12, s_ons[0]);
+  TEST_ASSERT_EQUAL((steps + 6) / 7, s_ons[1]);
+  TEST_ASSERT_EQUAL(0, s_ons[2]);
+  TEST_ASSERT_EQUAL(steps / 5, s_ons[3]);   // 4,3,2,1,0: step 0 comes fifth
+}
+
+// ---- Double buffer ----
+
+static void test_commit_while_stopped() {
+  Pattern& a = freshPattern();
+  seq_setStep(a, 0, 3, SEQ_STEP_DEFAULT);
+  play(a);
+  TEST_ASSERT_FALSE(seq_swapPending());
+  TEST_ASSERT_NOT_EQUAL(0, seq_getStep(seq_pattern(), 0, 3));
+
+  // The next working copy starts from what is playing, in the other buffer
+  SeqPattern* w = seq_edit();
+  TEST_ASSERT_NOT_NULL(w);
+  TEST_ASSERT_TRUE(w != &seq_pattern());
+  TEST_ASSERT_NOT_EQUAL(0, seq_getStep(*w, 0, 3));
+  seq_setStep(*w, 0, 3, 0);
+  TEST_ASSERT_NOT_EQUAL(0, seq_getStep(seq_pattern(), 0, 3));
+  seq_commit(SEQ_QUANT_BAR);
+  TEST_ASSERT_EQUAL(0, seq_getStep(seq_pattern(), 0, 3));
+}
+
+void setup() {
+  delay(2000);   // let the serial monitor attach
+  UNITY_BEGIN();
+  RUN_TEST(test_pack_roundtrip);
+  RUN_TEST(test_layouts_fire_alike);
+  RUN_TEST(test_swing_delays_offbeats);
+  RUN_TEST(test_nudges_clamp);
+  RUN_TEST(test_gates_balance);
+  RUN_TEST(test_rate_hit_counts);
+  RUN_TEST(test_directions);
+  RUN_TEST(test_off_grid_lengths);
+  RUN_TEST(test_commit_while_stopped);
+  UNITY_END();
+}
+
+void loop() {}